@@ -0,0 +1,60 @@
+#ifndef DOUBLE_BUFFER_H
+#define DOUBLE_BUFFER_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Single-writer double buffer with seqlock-validated reads.
+//
+// The writer fills the inactive slot (beginWrite() starts it as a copy of
+// the active one), then publish() swaps it in with release ordering. Readers
+// never lock: read() copies the active slot and retries if the writer may
+// have started reusing that slot meanwhile. That can only happen to a reader
+// preempted across a publish plus the next beginWrite(), e.g. acquisition on
+// another task while the web handler saves twice, so retries are rare and
+// the sample path never waits on the writer.
+//
+// The generation counter is odd while a write is in progress and advances by
+// two per publish.
+template <typename T>
+class DoubleBuffer {
+public:
+    DoubleBuffer() : active(&slots[0]) {}
+
+    T read() const {
+        for (;;) {
+            uint32_t before = gen.load(std::memory_order_acquire);
+            const T *src = active.load(std::memory_order_acquire);
+            T copy = *src;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t after = gen.load(std::memory_order_relaxed);
+
+            // A write in progress at the start targets the other slot, so
+            // src is only at risk once a publish and a new beginWrite() have
+            // both happened; either way the counter has moved by two
+            if (after - before < 2) return copy;
+        }
+    }
+
+    T &beginWrite() {
+        gen.store(gen.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        T *next = inactive();
+        *next = *active.load(std::memory_order_relaxed);
+        return *next;
+    }
+
+    void publish() {
+        active.store(inactive(), std::memory_order_release);
+        gen.store(gen.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    T *inactive() { return active.load(std::memory_order_relaxed) == &slots[0] ? &slots[1] : &slots[0]; }
+
+    T slots[2] = {};
+    std::atomic<T *> active;
+    std::atomic<uint32_t> gen{0};
+};
+
+#endif // DOUBLE_BUFFER_H
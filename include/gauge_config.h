@@ -1,7 +1,9 @@
 #ifndef GAUGE_CONFIG_H
 #define GAUGE_CONFIG_H
 
-#include <IPAddress.h>
+#include <stddef.h>
+#include "pressure_envelope.h"
+#include "sensor_diag.h"
 
 // NVS namespace
 #define NVS_NAMESPACE "gauge_cfg"
@@ -10,6 +12,7 @@
 #define DEFAULT_USE_SIMULATED_DATA      true
 #define DEFAULT_USE_SIMULATED_TEMP      true
 #define DEFAULT_USE_SIMULATED_HEADLIGHT true
+#define DEFAULT_USE_SIMULATED_RPM       true
 
 #define DEFAULT_SENSOR_MIN_VOLTAGE  0.5f
 #define DEFAULT_SENSOR_MAX_VOLTAGE  4.5f
@@ -26,6 +29,21 @@
 #define DEFAULT_BL_FADE_DURATION    500
 
 #define DEFAULT_EMA_ALPHA           0.15f
+#define DEFAULT_SCREEN              0     // index into SCREENS (screen_layout.h)
+
+#define DEFAULT_TACH_PULSES_PER_REV 3.0f  // V6 wasted-spark tach signal
+#define DEFAULT_ENV_FALLBACK_TEMP_C 90.0f  // envelope column used without a real oil temp sender
+
+#define DEFAULT_MEM_FRAG_WARN_PCT   40
+#define DEFAULT_TELEMETRY_HZ        0     // binary telemetry off; 100-1000 to enable
+
+#define DEFAULT_AP_IDLE_TIMEOUT_S   120   // AP shuts down after this long with no clients
+
+// Power management modes (cfg.pmMode, applied at boot)
+#define PM_MODE_OFF         0   // fixed full CPU clock
+#define PM_MODE_DFS         1   // scale CPU clock down when idle
+#define PM_MODE_LIGHT_SLEEP 2   // DFS + automatic light sleep between frames
+#define DEFAULT_PM_MODE     PM_MODE_DFS
 
 // WiFi AP settings
 #define WIFI_AP_SSID     "SW20-Gauge"
@@ -39,6 +57,7 @@ struct GaugeConfig {
     bool useSimulatedData;
     bool useSimulatedTemp;
     bool useSimulatedHeadlight;
+    bool useSimulatedRpm;
 
     // Sensor calibration
     float sensorMinVoltage;
@@ -52,6 +71,11 @@ struct GaugeConfig {
     float oilPressureMinWarn;
     float tempWarningHigh;
 
+    // Expected-pressure envelope (min PSI by RPM x oil temp)
+    float tachPulsesPerRev;
+    float envFallbackTempC;
+    float envelope[ENV_RPM_POINTS][ENV_TEMP_POINTS];
+
     // Backlight
     int blBrightnessDay;
     int blBrightnessNight;
@@ -59,12 +83,69 @@ struct GaugeConfig {
 
     // Display
     float emaAlpha;
+    int screen;
+
+    // Diagnostics
+    int memFragWarnPct;
+    int telemetryHz;
+
+    // WiFi
+    int apIdleTimeoutS;
+
+    // Power
+    int pmMode;
+};
+
+// Compiled defaults, i.e. what a cleared NVS namespace loads
+static inline GaugeConfig defaultGaugeConfig() {
+    GaugeConfig cfg = {};
+    cfg.useSimulatedData      = DEFAULT_USE_SIMULATED_DATA;
+    cfg.useSimulatedTemp      = DEFAULT_USE_SIMULATED_TEMP;
+    cfg.useSimulatedHeadlight = DEFAULT_USE_SIMULATED_HEADLIGHT;
+    cfg.useSimulatedRpm       = DEFAULT_USE_SIMULATED_RPM;
+    cfg.sensorMinVoltage      = DEFAULT_SENSOR_MIN_VOLTAGE;
+    cfg.sensorMaxVoltage      = DEFAULT_SENSOR_MAX_VOLTAGE;
+    cfg.sensorMaxPsi          = DEFAULT_SENSOR_MAX_PSI;
+    cfg.voltageDividerR1      = DEFAULT_VOLTAGE_DIVIDER_R1;
+    cfg.voltageDividerR2      = DEFAULT_VOLTAGE_DIVIDER_R2;
+    cfg.oilPressureMinSafe    = DEFAULT_OIL_PRESSURE_MIN_SAFE;
+    cfg.oilPressureMinWarn    = DEFAULT_OIL_PRESSURE_MIN_WARN;
+    cfg.tempWarningHigh       = DEFAULT_TEMP_WARNING_HIGH;
+    cfg.tachPulsesPerRev      = DEFAULT_TACH_PULSES_PER_REV;
+    cfg.envFallbackTempC      = DEFAULT_ENV_FALLBACK_TEMP_C;
+    for (int i = 0; i < ENV_RPM_POINTS; i++) {
+        for (int j = 0; j < ENV_TEMP_POINTS; j++) cfg.envelope[i][j] = DEFAULT_ENVELOPE[i][j];
+    }
+    cfg.blBrightnessDay       = DEFAULT_BL_BRIGHTNESS_DAY;
+    cfg.blBrightnessNight     = DEFAULT_BL_BRIGHTNESS_NIGHT;
+    cfg.blFadeDuration        = DEFAULT_BL_FADE_DURATION;
+    cfg.emaAlpha              = DEFAULT_EMA_ALPHA;
+    cfg.screen                = DEFAULT_SCREEN;
+    cfg.memFragWarnPct        = DEFAULT_MEM_FRAG_WARN_PCT;
+    cfg.telemetryHz           = DEFAULT_TELEMETRY_HZ;
+    cfg.apIdleTimeoutS        = DEFAULT_AP_IDLE_TIMEOUT_S;
+    cfg.pmMode                = DEFAULT_PM_MODE;
+    return cfg;
+}
+
+// Published configuration: settings plus values derived from them once per
+// publish, so the sample path never recomputes them
+struct ConfigSnapshot {
+    GaugeConfig cfg;
+
+    // Pressure = adc counts * psiPerAdcCount + psiOffset (before clamping)
+    float psiPerAdcCount;
+    float psiOffset;
+
+    // Sender fault thresholds from the voltage span and divider
+    SensorLimits sensorLimits;
 };
 
 // NVS key names (max 15 chars for Preferences.h)
 #define KEY_SIM_DATA    "simData"
 #define KEY_SIM_TEMP    "simTemp"
 #define KEY_SIM_HL      "simHL"
+#define KEY_SIM_RPM     "simRpm"
 #define KEY_SENS_MIN_V  "sensMinV"
 #define KEY_SENS_MAX_V  "sensMaxV"
 #define KEY_SENS_MAX_P  "sensMaxP"
@@ -73,9 +154,58 @@ struct GaugeConfig {
 #define KEY_OIL_SAFE    "oilSafe"
 #define KEY_OIL_WARN    "oilWarn"
 #define KEY_TEMP_WARN   "tempWarn"
+#define KEY_TACH_PPR    "tachPPR"
+#define KEY_ENV_TEMP    "envTempC"
+#define KEY_ENVELOPE    "envelope"
 #define KEY_BL_DAY      "blDay"
 #define KEY_BL_NIGHT    "blNight"
 #define KEY_BL_FADE     "blFade"
 #define KEY_EMA_ALPHA   "emaAlpha"
+#define KEY_SCREEN      "screen"
+#define KEY_MEM_FRAG    "memFrag"
+#define KEY_TELEM_HZ    "telemHz"
+#define KEY_AP_IDLE     "apIdle"
+#define KEY_PM_MODE     "pmMode"
+
+// Scalar settings by key, for the JSON API (the envelope table is handled
+// separately). Keys double as NVS keys.
+enum ConfigFieldType {
+    CFG_BOOL,
+    CFG_INT,
+    CFG_FLOAT
+};
+
+struct ConfigField {
+    const char *key;
+    ConfigFieldType type;
+    size_t offset;
+};
+
+static const ConfigField CONFIG_FIELDS[] = {
+    {KEY_SIM_DATA,   CFG_BOOL,  offsetof(GaugeConfig, useSimulatedData)},
+    {KEY_SIM_TEMP,   CFG_BOOL,  offsetof(GaugeConfig, useSimulatedTemp)},
+    {KEY_SIM_HL,     CFG_BOOL,  offsetof(GaugeConfig, useSimulatedHeadlight)},
+    {KEY_SIM_RPM,    CFG_BOOL,  offsetof(GaugeConfig, useSimulatedRpm)},
+    {KEY_SENS_MIN_V, CFG_FLOAT, offsetof(GaugeConfig, sensorMinVoltage)},
+    {KEY_SENS_MAX_V, CFG_FLOAT, offsetof(GaugeConfig, sensorMaxVoltage)},
+    {KEY_SENS_MAX_P, CFG_FLOAT, offsetof(GaugeConfig, sensorMaxPsi)},
+    {KEY_VD_R1,      CFG_FLOAT, offsetof(GaugeConfig, voltageDividerR1)},
+    {KEY_VD_R2,      CFG_FLOAT, offsetof(GaugeConfig, voltageDividerR2)},
+    {KEY_OIL_SAFE,   CFG_FLOAT, offsetof(GaugeConfig, oilPressureMinSafe)},
+    {KEY_OIL_WARN,   CFG_FLOAT, offsetof(GaugeConfig, oilPressureMinWarn)},
+    {KEY_TEMP_WARN,  CFG_FLOAT, offsetof(GaugeConfig, tempWarningHigh)},
+    {KEY_TACH_PPR,   CFG_FLOAT, offsetof(GaugeConfig, tachPulsesPerRev)},
+    {KEY_ENV_TEMP,   CFG_FLOAT, offsetof(GaugeConfig, envFallbackTempC)},
+    {KEY_BL_DAY,     CFG_INT,   offsetof(GaugeConfig, blBrightnessDay)},
+    {KEY_BL_NIGHT,   CFG_INT,   offsetof(GaugeConfig, blBrightnessNight)},
+    {KEY_BL_FADE,    CFG_INT,   offsetof(GaugeConfig, blFadeDuration)},
+    {KEY_EMA_ALPHA,  CFG_FLOAT, offsetof(GaugeConfig, emaAlpha)},
+    {KEY_SCREEN,     CFG_INT,   offsetof(GaugeConfig, screen)},
+    {KEY_MEM_FRAG,   CFG_INT,   offsetof(GaugeConfig, memFragWarnPct)},
+    {KEY_TELEM_HZ,   CFG_INT,   offsetof(GaugeConfig, telemetryHz)},
+    {KEY_AP_IDLE,    CFG_INT,   offsetof(GaugeConfig, apIdleTimeoutS)},
+    {KEY_PM_MODE,    CFG_INT,   offsetof(GaugeConfig, pmMode)},
+};
+#define CONFIG_FIELD_COUNT (sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]))
 
 #endif // GAUGE_CONFIG_H
@@ -0,0 +1,23 @@
+#ifndef GAUGE_FONTS_H
+#define GAUGE_FONTS_H
+
+#include <lvgl.h>
+
+// Fonts by role. With GAUGE_SUBSET_FONTS the build generates glyph-subsetted
+// versions (see scripts/font_subset.py); otherwise LVGL's built-ins are used.
+#if GAUGE_SUBSET_FONTS
+LV_FONT_DECLARE(gauge_font_12)
+LV_FONT_DECLARE(gauge_font_16)
+LV_FONT_DECLARE(gauge_font_48)
+#define FONT_CAPTION (&gauge_font_12)
+#define FONT_TICKS   (&gauge_font_16)
+#define FONT_READOUT (&gauge_font_48)
+#else
+#define FONT_CAPTION (&lv_font_montserrat_12)
+#define FONT_TICKS   (&lv_font_montserrat_16)
+#define FONT_READOUT (&lv_font_montserrat_48)
+#endif
+
+#define FONT_LABEL   (&lv_font_montserrat_14)
+
+#endif // GAUGE_FONTS_H
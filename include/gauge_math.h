@@ -0,0 +1,82 @@
+#ifndef GAUGE_MATH_H
+#define GAUGE_MATH_H
+
+#include <math.h>
+#include <stdint.h>
+#include "gauge_config.h"
+#include "screen_layout.h"
+
+// Pure hot-path math shared by the firmware. No Arduino dependencies so it
+// can be compiled and exercised on a host.
+
+#define GAUGE_TEMP_MIN_F 100
+#define GAUGE_TEMP_MAX_F 260
+
+template <typename T>
+static inline T clampValue(T v, T lo, T hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// One exponential moving average step
+static inline float emaStep(float prev, float sample, float alpha) {
+    return prev * (1 - alpha) + sample * alpha;
+}
+
+// Celsius to whole Fahrenheit, clamped to the meter scale
+static inline int celsiusToGaugeF(float c) {
+    return clampValue((int)(c * 9.0f / 5.0f + 32.0f), GAUGE_TEMP_MIN_F, GAUGE_TEMP_MAX_F);
+}
+
+// Fold ADC reference, voltage divider and sensor span into one linear map:
+// psi = adc * psiPerCount + psiOffset
+static inline void pressureCoefficients(const GaugeConfig &cfg, float vref, float maxCount,
+                                        float *psiPerCount, float *psiOffset) {
+    float voltsPerCount = vref / maxCount * (cfg.voltageDividerR1 + cfg.voltageDividerR2) / cfg.voltageDividerR2;
+    float psiPerVolt = cfg.sensorMaxPsi / (cfg.sensorMaxVoltage - cfg.sensorMinVoltage);
+    *psiPerCount = voltsPerCount * psiPerVolt;
+    *psiOffset = -cfg.sensorMinVoltage * psiPerVolt;
+}
+
+// Sender output voltage to raw counts at the ADC pin, clamped to the ADC range
+static inline uint16_t sensorVoltsToAdc(const GaugeConfig &cfg, float volts, float vref, float maxCount) {
+    float pin = volts * cfg.voltageDividerR2 / (cfg.voltageDividerR1 + cfg.voltageDividerR2);
+    return (uint16_t)clampValue(pin / vref * maxCount, 0.0f, maxCount);
+}
+
+static inline float adcToPsi(float adc, float psiPerCount, float psiOffset, float maxPsi) {
+    return clampValue(adc * psiPerCount + psiOffset, 0.0f, maxPsi);
+}
+
+// Perceptual 0-255 brightness to PWM duty
+static inline uint16_t gammaDuty(int level, float gamma, uint16_t maxDuty) {
+    return (uint16_t)lroundf(powf(clampValue(level, 0, 255) / 255.0f, gamma) * maxDuty);
+}
+
+// Clamp a candidate config into safe ranges before it is published
+static inline void validateConfig(GaugeConfig &cfg) {
+    if (cfg.voltageDividerR2 <= 0) cfg.voltageDividerR2 = DEFAULT_VOLTAGE_DIVIDER_R2;
+    if (cfg.sensorMinVoltage >= cfg.sensorMaxVoltage) {
+        cfg.sensorMinVoltage = DEFAULT_SENSOR_MIN_VOLTAGE;
+        cfg.sensorMaxVoltage = DEFAULT_SENSOR_MAX_VOLTAGE;
+    }
+    // Telemetry carries PSI x100 in an int16, so 327 is a hard ceiling
+    cfg.sensorMaxPsi = cfg.sensorMaxPsi > 0 ? clampValue(cfg.sensorMaxPsi, 10.0f, 300.0f) : DEFAULT_SENSOR_MAX_PSI;
+    cfg.blBrightnessDay   = clampValue(cfg.blBrightnessDay, 0, 255);
+    cfg.blBrightnessNight = clampValue(cfg.blBrightnessNight, 0, 255);
+    cfg.blFadeDuration    = clampValue(cfg.blFadeDuration, 0, 5000);
+    cfg.emaAlpha          = clampValue(cfg.emaAlpha, 0.01f, 1.0f);
+    cfg.screen            = clampValue(cfg.screen, 0, SCREEN_COUNT - 1);
+    cfg.memFragWarnPct    = clampValue(cfg.memFragWarnPct, 1, 100);
+    cfg.telemetryHz       = cfg.telemetryHz <= 0 ? 0 : clampValue(cfg.telemetryHz, 100, 1000);
+    cfg.apIdleTimeoutS    = clampValue(cfg.apIdleTimeoutS, 30, 3600);
+    cfg.pmMode            = clampValue(cfg.pmMode, PM_MODE_OFF, PM_MODE_LIGHT_SLEEP);
+    if (cfg.tachPulsesPerRev <= 0) cfg.tachPulsesPerRev = DEFAULT_TACH_PULSES_PER_REV;
+    cfg.envFallbackTempC  = clampValue(cfg.envFallbackTempC, ENV_TEMP_AXIS[0], ENV_TEMP_AXIS[ENV_TEMP_POINTS - 1]);
+    for (int i = 0; i < ENV_RPM_POINTS; i++) {
+        for (int j = 0; j < ENV_TEMP_POINTS; j++) {
+            cfg.envelope[i][j] = clampValue(cfg.envelope[i][j], 0.0f, cfg.sensorMaxPsi);
+        }
+    }
+}
+
+#endif // GAUGE_MATH_H
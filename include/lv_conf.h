@@ -88,8 +88,9 @@
  * LV_LOG_LEVEL_NONE        Do not log anything */
 #define LV_LOG_LEVEL LV_LOG_LEVEL_WARN
 
-/* 1: Print the log with 'printf'; 0: User need to register a callback with `lv_log_register_print_cb()` */
-#define LV_LOG_PRINTF 1
+/* 1: Print the log with 'printf'; 0: User need to register a callback with `lv_log_register_print_cb()`
+ * Off: main.cpp routes LVGL's log through logPrintf() so it stays off the port during binary telemetry */
+#define LV_LOG_PRINTF 0
 
 #endif  /*LV_USE_LOG*/
 
@@ -104,18 +105,23 @@
  * FONT USAGE
  *==================*/
 
-/* Montserrat fonts with ASCII range and some symbols */
+/* Montserrat fonts with ASCII range and some symbols.
+ * 12, 16 and 48 come from glyph-subsetted fonts (scripts/font_subset.py) when
+ * GAUGE_SUBSET_FONTS is set by the build; 14 stays built in as the default. */
+#ifndef GAUGE_SUBSET_FONTS
+#define GAUGE_SUBSET_FONTS 0
+#endif
 #define LV_FONT_MONTSERRAT_8  0
 #define LV_FONT_MONTSERRAT_10 0
-#define LV_FONT_MONTSERRAT_12 1
+#define LV_FONT_MONTSERRAT_12 (!GAUGE_SUBSET_FONTS)
 #define LV_FONT_MONTSERRAT_14 1
-#define LV_FONT_MONTSERRAT_16 1
-#define LV_FONT_MONTSERRAT_18 1
-#define LV_FONT_MONTSERRAT_20 1
-#define LV_FONT_MONTSERRAT_22 1
-#define LV_FONT_MONTSERRAT_24 1
-#define LV_FONT_MONTSERRAT_26 1
-#define LV_FONT_MONTSERRAT_28 1
+#define LV_FONT_MONTSERRAT_16 (!GAUGE_SUBSET_FONTS)
+#define LV_FONT_MONTSERRAT_18 0
+#define LV_FONT_MONTSERRAT_20 0
+#define LV_FONT_MONTSERRAT_22 0
+#define LV_FONT_MONTSERRAT_24 0
+#define LV_FONT_MONTSERRAT_26 0
+#define LV_FONT_MONTSERRAT_28 0
 #define LV_FONT_MONTSERRAT_30 0
 #define LV_FONT_MONTSERRAT_32 0
 #define LV_FONT_MONTSERRAT_34 0
@@ -125,7 +131,7 @@
 #define LV_FONT_MONTSERRAT_42 0
 #define LV_FONT_MONTSERRAT_44 0
 #define LV_FONT_MONTSERRAT_46 0
-#define LV_FONT_MONTSERRAT_48 1
+#define LV_FONT_MONTSERRAT_48 (!GAUGE_SUBSET_FONTS)
 
 /* Demonstrate special features */
 #define LV_FONT_MONTSERRAT_28_COMPRESSED 0
@@ -155,7 +161,7 @@
 
 #define LV_USE_ARC          1
 #define LV_USE_ANIMIMG      0
-#define LV_USE_BAR          0
+#define LV_USE_BAR          1  /* Bar screen (WK_BAR) */
 #define LV_USE_BTN          0
 #define LV_USE_BTNMATRIX    0
 #define LV_USE_CANVAS       0
@@ -0,0 +1,147 @@
+#ifndef OTA_STREAM_H
+#define OTA_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Streaming firmware update: upload data is gathered into one fixed-size
+// chunk buffer and written to the backend a chunk at a time, hashing as it
+// goes. The image is only committed if its SHA-256 matches. Flash access and
+// hashing sit behind small interfaces so a fake partition can stand in on
+// a host.
+
+#define OTA_SHA256_LEN 32
+
+class OtaBackend {
+public:
+    virtual ~OtaBackend() {}
+    virtual bool begin() = 0;
+    virtual bool write(const uint8_t *data, size_t len) = 0;
+    virtual bool commit() = 0;   // finalize and make it the boot image
+    virtual void abort() = 0;
+};
+
+class OtaHasher {
+public:
+    virtual ~OtaHasher() {}
+    virtual void begin() = 0;
+    virtual void update(const uint8_t *data, size_t len) = 0;
+    virtual void finish(uint8_t out[OTA_SHA256_LEN]) = 0;
+};
+
+// Parse 64 hex characters into a digest
+static inline bool parseSha256Hex(const char *hex, uint8_t out[OTA_SHA256_LEN]) {
+    if (!hex || strlen(hex) != OTA_SHA256_LEN * 2) return false;
+    for (int i = 0; i < OTA_SHA256_LEN * 2; i++) {
+        char c = hex[i];
+        int v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else return false;
+        if (i & 1) out[i / 2] |= v;
+        else out[i / 2] = v << 4;
+    }
+    return true;
+}
+
+enum OtaState {
+    OTA_IDLE,
+    OTA_RECEIVING,
+    OTA_DONE,
+    OTA_FAILED
+};
+
+template <size_t CHUNK>
+class OtaStream {
+public:
+    OtaStream(OtaBackend &backend, OtaHasher &hasher) : backend(backend), hasher(hasher) {}
+
+    bool begin(const uint8_t expected[OTA_SHA256_LEN]) {
+        if (state == OTA_RECEIVING) {
+            backend.abort();
+            state = OTA_IDLE;   // so a failing backend.begin() doesn't abort twice
+        }
+        memcpy(expectedHash, expected, OTA_SHA256_LEN);
+        fill = 0;
+        received = 0;
+        err = nullptr;
+        if (!backend.begin()) return fail("no OTA partition");
+        hasher.begin();
+        state = OTA_RECEIVING;
+        return true;
+    }
+
+    bool write(const uint8_t *data, size_t len) {
+        if (state != OTA_RECEIVING) return false;
+        received += len;
+        while (len > 0) {
+            size_t n = CHUNK - fill;
+            if (n > len) n = len;
+            memcpy(buf + fill, data, n);
+            fill += n;
+            data += n;
+            len -= n;
+            if (fill == CHUNK && !flush()) return false;
+        }
+        return true;
+    }
+
+    // Flush the tail, verify the digest and commit; aborts on any mismatch
+    bool end() {
+        if (state != OTA_RECEIVING) return false;
+        if (fill > 0 && !flush()) return false;
+        if (received == 0) return fail("empty image");
+
+        uint8_t actual[OTA_SHA256_LEN];
+        hasher.finish(actual);
+        if (memcmp(actual, expectedHash, OTA_SHA256_LEN) != 0) return fail("SHA-256 mismatch");
+        if (!backend.commit()) return fail("image rejected");
+        state = OTA_DONE;
+        return true;
+    }
+
+    void abort() {
+        if (state == OTA_RECEIVING) backend.abort();
+        state = OTA_IDLE;
+    }
+
+    // Refuse an upload before it starts (e.g. a bad request), dropping any
+    // earlier one, so status() and error() describe this upload
+    void reject(const char *why) {
+        fill = 0;
+        received = 0;
+        fail(why);
+    }
+
+    OtaState status() const { return state; }
+    uint32_t bytesReceived() const { return received; }
+    const char *error() const { return err ? err : ""; }
+
+private:
+    bool flush() {
+        hasher.update(buf, fill);
+        if (!backend.write(buf, fill)) return fail("flash write failed");
+        fill = 0;
+        return true;
+    }
+
+    bool fail(const char *why) {
+        if (state == OTA_RECEIVING) backend.abort();
+        err = why;
+        state = OTA_FAILED;
+        return false;
+    }
+
+    OtaBackend &backend;
+    OtaHasher &hasher;
+    uint8_t buf[CHUNK];
+    size_t fill = 0;
+    uint32_t received = 0;
+    uint8_t expectedHash[OTA_SHA256_LEN];
+    OtaState state = OTA_IDLE;
+    const char *err = nullptr;
+};
+
+#endif // OTA_STREAM_H
@@ -0,0 +1,48 @@
+#ifndef POWER_STATS_H
+#define POWER_STATS_H
+
+#include <stdint.h>
+
+// Idle accounting for the power-managed loop: time spent running jobs versus
+// time handed back to the idle task (where DFS and light sleep act), and how
+// late each idle period ended compared with what was asked for. Late wakes
+// push back the next job release, so the histogram is what shows whether
+// power saving costs needle responsiveness.
+
+#define WAKE_BUCKETS 5
+
+// Upper bounds of the lateness buckets in microseconds; the last is open
+static const uint32_t WAKE_BUCKET_US[WAKE_BUCKETS - 1] = {100, 500, 1000, 2000};
+
+struct PowerStats {
+    uint64_t busyUs;
+    uint64_t idleUs;
+    uint32_t wakes;
+    uint64_t sumWakeLateUs;
+    uint32_t maxWakeLateUs;
+    uint32_t wakeHist[WAKE_BUCKETS];
+
+    void addBusy(uint32_t us) { busyUs += us; }
+
+    void addIdle(uint32_t requestedUs, uint32_t actualUs) {
+        idleUs += actualUs;
+        uint32_t late = actualUs > requestedUs ? actualUs - requestedUs : 0;
+        wakes++;
+        sumWakeLateUs += late;
+        if (late > maxWakeLateUs) maxWakeLateUs = late;
+
+        int b = 0;
+        while (b < WAKE_BUCKETS - 1 && late >= WAKE_BUCKET_US[b]) b++;
+        wakeHist[b]++;
+    }
+
+    // Share of loop time spent running jobs, in percent
+    float dutyPct() const {
+        uint64_t total = busyUs + idleUs;
+        return total ? 100.0f * busyUs / total : 0.0f;
+    }
+
+    uint32_t meanWakeLateUs() const { return wakes ? (uint32_t)(sumWakeLateUs / wakes) : 0; }
+};
+
+#endif // POWER_STATS_H
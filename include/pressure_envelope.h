@@ -0,0 +1,55 @@
+#ifndef PRESSURE_ENVELOPE_H
+#define PRESSURE_ENVELOPE_H
+
+// Expected minimum oil pressure as a function of engine RPM and oil temperature.
+// The table is indexed [rpm][temp] against the fixed axes below and looked up
+// with bilinear interpolation; inputs outside the axes clamp to the edge.
+
+#define ENV_RPM_POINTS  8
+#define ENV_TEMP_POINTS 4
+
+static const float ENV_RPM_AXIS[ENV_RPM_POINTS]   = {0, 1000, 2000, 3000, 4000, 5000, 6000, 7000};
+static const float ENV_TEMP_AXIS[ENV_TEMP_POINTS] = {20, 60, 90, 120};  // deg C
+
+// Defaults from the 2GR-FE spec (11.6 PSI hot idle, 55.5+ PSI at 6000 RPM)
+// with some margin so normal variation does not trip the alert.
+static const float DEFAULT_ENVELOPE[ENV_RPM_POINTS][ENV_TEMP_POINTS] = {
+    // 20C   60C   90C   120C
+    {  0.0,  0.0,  0.0,  0.0},  // 0 RPM (engine off)
+    { 16.0, 11.0,  8.0,  6.0},  // 1000
+    { 28.0, 20.0, 16.0, 13.0},  // 2000
+    { 38.0, 29.0, 24.0, 20.0},  // 3000
+    { 48.0, 37.0, 32.0, 27.0},  // 4000
+    { 54.0, 43.0, 38.0, 32.0},  // 5000
+    { 58.0, 49.0, 44.0, 37.0},  // 6000
+    { 60.0, 51.0, 46.0, 39.0},  // 7000
+};
+
+// Locate x on a monotonic axis: returns the lower index and the 0..1 fraction
+// towards the next point.
+static inline int envelopeAxisIndex(const float *axis, int n, float x, float *frac) {
+    if (x <= axis[0]) {
+        *frac = 0.0f;
+        return 0;
+    }
+    if (x >= axis[n - 1]) {
+        *frac = 1.0f;
+        return n - 2;
+    }
+    int i = 0;
+    while (x >= axis[i + 1]) i++;
+    *frac = (x - axis[i]) / (axis[i + 1] - axis[i]);
+    return i;
+}
+
+static inline float envelopeLookup(const float table[ENV_RPM_POINTS][ENV_TEMP_POINTS], float rpm, float tempC) {
+    float fr, ft;
+    int r = envelopeAxisIndex(ENV_RPM_AXIS, ENV_RPM_POINTS, rpm, &fr);
+    int t = envelopeAxisIndex(ENV_TEMP_AXIS, ENV_TEMP_POINTS, tempC, &ft);
+
+    float lo = table[r][t]     + (table[r][t + 1]     - table[r][t])     * ft;
+    float hi = table[r + 1][t] + (table[r + 1][t + 1] - table[r + 1][t]) * ft;
+    return lo + (hi - lo) * fr;
+}
+
+#endif // PRESSURE_ENVELOPE_H
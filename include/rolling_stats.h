@@ -0,0 +1,145 @@
+#ifndef ROLLING_STATS_H
+#define ROLLING_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-capacity monotonic deque for sliding-window min/max.
+// Entries are (sequence, value); storage is a ring so push/pop never allocate.
+// Holds at most N entries: expire() must make room before a push to a full deque.
+template <size_t N>
+class MonotonicDeque {
+public:
+    void reset() { head = 0; size = 0; }
+
+    // keepMin = true keeps values ascending (front is the window minimum),
+    // false keeps them descending (front is the window maximum).
+    void push(uint32_t seq, float value, bool keepMin) {
+        while (size > 0) {
+            float back = entries[(head + size - 1) % N].value;
+            if (keepMin ? back < value : back > value) break;
+            size--;
+        }
+        entries[(head + size) % N] = {seq, value};
+        size++;
+    }
+
+    // Drop entries whose sequence number fell out of the window
+    void expire(uint32_t oldestSeq) {
+        while (size > 0 && (int32_t)(entries[head].seq - oldestSeq) < 0) {
+            head = (head + 1) % N;
+            size--;
+        }
+    }
+
+    bool empty() const { return size == 0; }
+    float front() const { return entries[head].value; }
+
+private:
+    struct Entry {
+        uint32_t seq;
+        float value;
+    };
+    Entry entries[N];
+    size_t head = 0;
+    size_t size = 0;
+};
+
+// Min/max/mean over the last N samples, O(1) amortized per sample
+template <size_t N>
+class WindowStats {
+public:
+    void reset() {
+        minQ.reset();
+        maxQ.reset();
+        next = 0;
+        count = 0;
+        sum = 0.0;
+    }
+
+    void push(float value) {
+        size_t slot = next % N;
+        if (count == N) {
+            sum -= values[slot];
+        } else {
+            count++;
+        }
+        values[slot] = value;
+        sum += value;
+
+        // With N entries in the window, sequences older than next - N + 1 are
+        // stale. Expire first: the deques hold N entries, and a monotonic run
+        // fills them, so pushing first would overwrite the front.
+        uint32_t oldest = next + 1 - (uint32_t)N;
+        minQ.expire(oldest);
+        maxQ.expire(oldest);
+        minQ.push(next, value, true);
+        maxQ.push(next, value, false);
+        next++;
+    }
+
+    size_t samples() const { return count; }
+    float min() const { return minQ.empty() ? 0.0f : minQ.front(); }
+    float max() const { return maxQ.empty() ? 0.0f : maxQ.front(); }
+    float mean() const { return count ? (float)(sum / count) : 0.0f; }
+
+private:
+    float values[N];
+    MonotonicDeque<N> minQ;
+    MonotonicDeque<N> maxQ;
+    uint32_t next = 0;
+    size_t count = 0;
+    double sum = 0.0;  // double keeps add/subtract drift negligible over hours
+};
+
+// Unbounded (since boot or last reset) min/max/mean
+class SessionStats {
+public:
+    void reset() {
+        count = 0;
+        sum = 0.0;
+        lo = 0.0f;
+        hi = 0.0f;
+    }
+
+    void push(float value) {
+        if (count == 0 || value < lo) lo = value;
+        if (count == 0 || value > hi) hi = value;
+        sum += value;
+        count++;
+    }
+
+    uint32_t samples() const { return count; }
+    float min() const { return lo; }
+    float max() const { return hi; }
+    float mean() const { return count ? (float)(sum / count) : 0.0f; }
+
+private:
+    uint32_t count = 0;
+    double sum = 0.0;
+    float lo = 0.0f;
+    float hi = 0.0f;
+};
+
+// Short window, long window and session statistics for one signal.
+// Window lengths are in samples so nothing is sized at runtime.
+template <size_t SHORT_N, size_t LONG_N>
+struct RollingStats {
+    WindowStats<SHORT_N> shortWin;
+    WindowStats<LONG_N> longWin;
+    SessionStats session;
+
+    void reset() {
+        shortWin.reset();
+        longWin.reset();
+        session.reset();
+    }
+
+    void push(float value) {
+        shortWin.push(value);
+        longWin.push(value);
+        session.push(value);
+    }
+};
+
+#endif // ROLLING_STATS_H
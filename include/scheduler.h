@@ -0,0 +1,159 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Fixed-rate cooperative scheduler.
+//
+// Each job has a period, a deadline (relative to its release time) and a
+// priority (0 = highest). Releases are fixed-rate: the next release is the
+// previous one plus the period, so timing does not drift with how long a
+// loop iteration took. When several jobs are due the highest priority runs
+// first. No Arduino dependencies: the clock is injected, so the same code
+// runs against micros() on the gauge and a fake clock on the host.
+
+typedef uint32_t (*SchedClockFn)();   // microseconds, free running, wraps
+typedef void (*SchedJobFn)();
+
+struct SchedJobStats {
+    uint32_t runs;
+    uint32_t overruns;      // finished later than release + deadline
+    uint32_t skipped;       // releases dropped because the job fell a full period behind
+    uint32_t maxJitterUs;   // start time minus release time
+    uint64_t sumJitterUs;
+    uint32_t maxRunUs;
+    uint32_t lastRunUs;
+
+    uint32_t meanJitterUs() const { return runs ? (uint32_t)(sumJitterUs / runs) : 0; }
+};
+
+struct SchedJob {
+    const char *name;
+    SchedJobFn fn;
+    uint32_t periodUs;
+    uint32_t deadlineUs;
+    uint8_t priority;
+    uint32_t nextRelease;
+    SchedJobStats stats;
+};
+
+template <size_t MAX_JOBS>
+class Scheduler {
+public:
+    explicit Scheduler(SchedClockFn clock) : clock(clock) {}
+
+    // Register a job; offsetUs staggers its first release after start()
+    bool add(const char *name, SchedJobFn fn, uint32_t periodUs, uint32_t deadlineUs,
+             uint8_t priority, uint32_t offsetUs = 0) {
+        if (count >= MAX_JOBS || periodUs == 0) return false;
+        SchedJob &j = jobs[count++];
+        j = {};
+        j.name = name;
+        j.fn = fn;
+        j.periodUs = periodUs;
+        j.deadlineUs = deadlineUs;
+        j.priority = priority;
+        j.nextRelease = offsetUs;  // made absolute in start()
+        return true;
+    }
+
+    void start() {
+        uint32_t now = clock();
+        for (size_t i = 0; i < count; i++) {
+            jobs[i].nextRelease += now;
+        }
+    }
+
+    // Run the highest-priority due job, if any. Returns microseconds until
+    // the next release (0 if something is already due) so the caller can idle.
+    uint32_t runOnce() {
+        uint32_t now = clock();
+        SchedJob *due = nullptr;
+        for (size_t i = 0; i < count; i++) {
+            SchedJob &j = jobs[i];
+            if ((int32_t)(now - j.nextRelease) < 0) continue;
+            if (!due || j.priority < due->priority ||
+                (j.priority == due->priority && (int32_t)(j.nextRelease - due->nextRelease) < 0)) {
+                due = &j;
+            }
+        }
+
+        if (due) {
+            run(*due, now);
+        }
+        return untilNextRelease();
+    }
+
+    // Change a job's period at runtime; its next release keeps its phase
+    bool setPeriod(const char *name, uint32_t periodUs) {
+        if (periodUs == 0) return false;
+        for (size_t i = 0; i < count; i++) {
+            if (strcmp(jobs[i].name, name) == 0) {
+                jobs[i].periodUs = periodUs;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const SchedJob *find(const char *name) const {
+        for (size_t i = 0; i < count; i++) {
+            if (strcmp(jobs[i].name, name) == 0) return &jobs[i];
+        }
+        return nullptr;
+    }
+
+    size_t size() const { return count; }
+    const SchedJob &job(size_t i) const { return jobs[i]; }
+
+    void resetStats() {
+        for (size_t i = 0; i < count; i++) {
+            jobs[i].stats = {};
+        }
+    }
+
+private:
+    void run(SchedJob &j, uint32_t start) {
+        uint32_t release = j.nextRelease;
+        uint32_t jitter = start - release;
+
+        j.fn();
+        uint32_t end = clock();
+
+        SchedJobStats &st = j.stats;
+        st.runs++;
+        st.sumJitterUs += jitter;
+        if (jitter > st.maxJitterUs) st.maxJitterUs = jitter;
+        st.lastRunUs = end - start;
+        if (st.lastRunUs > st.maxRunUs) st.maxRunUs = st.lastRunUs;
+        if (end - release > j.deadlineUs) st.overruns++;
+
+        // Fixed-rate release; if a whole period was missed, drop the backlog
+        // rather than running the job back-to-back to catch up
+        j.nextRelease = release + j.periodUs;
+        if ((int32_t)(end - j.nextRelease) >= (int32_t)j.periodUs) {
+            uint32_t missed = (end - j.nextRelease) / j.periodUs;
+            st.skipped += missed;
+            j.nextRelease += missed * j.periodUs;
+        }
+    }
+
+    uint32_t untilNextRelease() const {
+        uint32_t now = clock();
+        uint32_t wait = UINT32_MAX;
+        for (size_t i = 0; i < count; i++) {
+            int32_t d = (int32_t)(jobs[i].nextRelease - now);
+            if (d <= 0) return 0;
+            if ((uint32_t)d < wait) wait = (uint32_t)d;
+        }
+        return wait;
+    }
+
+    SchedClockFn clock;
+    SchedJob jobs[MAX_JOBS];
+    size_t count = 0;
+};
+
+#endif // SCHEDULER_H
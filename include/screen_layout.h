@@ -0,0 +1,125 @@
+#ifndef SCREEN_LAYOUT_H
+#define SCREEN_LAYOUT_H
+
+#include <stdint.h>
+
+// Declarative screen layouts. Each screen is a table of widgets placed
+// relative to the display centre; a widget either shows static text or is
+// bound to a live value. screen_view.h builds a screen from its table the
+// first time it is shown and keeps it resident, so switching screens never
+// allocates from the LVGL pool once every screen has been visited.
+// No LVGL types here: fonts and colours are role ids resolved by screen_view.h.
+
+enum WidgetKind : uint8_t {
+    WK_TEXT,        // static label
+    WK_VALUE,       // label formatted from a binding ("%s" receives the number or "--")
+    WK_TEMP_METER,  // temperature arc with needle and session hold band
+    WK_BAR,         // horizontal bar over [rangeMin, rangeMax]
+    WK_ALARM_LIST,  // most recent alarm log entries, newest first
+    WK_FAULT        // sender fault name ("%s"), empty while the sender is healthy
+};
+
+enum WidgetBinding : uint8_t {
+    BIND_NONE,
+    BIND_PSI,
+    BIND_TEMP_F,
+    BIND_RPM,
+    BIND_EXPECTED_PSI,
+    BIND_PSI_MIN,       // session hold values
+    BIND_PSI_MAX,
+    BIND_PSI_AVG_10S,
+    BIND_TEMP_MIN_F,
+    BIND_TEMP_MAX_F,
+    BIND_ALARM_COUNT,
+    BIND_SENSOR_FAULT
+};
+
+enum WidgetFont : uint8_t { WF_CAPTION, WF_LABEL, WF_TICKS, WF_READOUT };
+enum WidgetColor : uint8_t { WC_WHITE, WC_GREY, WC_WARNING };
+
+#define WIDGET_ALARM_COLOR 0x01   // drawn in WC_WARNING while pressure is low or the sender is faulted
+
+struct WidgetDesc {
+    uint8_t kind;
+    uint8_t binding;
+    uint8_t font;
+    uint8_t color;
+    uint8_t flags;
+    int16_t x, y;           // offset of the widget centre from the screen centre
+    int16_t w, h;           // 0 = size to content
+    int16_t rangeMin, rangeMax;
+    const char *text;
+};
+
+struct ScreenDesc {
+    const char *name;
+    const WidgetDesc *widgets;
+    uint8_t count;
+    uint16_t memBudget;     // LVGL pool bytes the built screen may occupy
+};
+
+#define SCREEN_MAX_WIDGETS 10
+#define ALARM_LIST_LINES 6
+
+// Main gauge: temperature arc plus large pressure digits with LO/HI hold
+static const WidgetDesc GAUGE_WIDGETS[] = {
+    {WK_TEMP_METER, BIND_TEMP_F,  WF_TICKS,   WC_WHITE, 0, 0,   0,   232, 232, 0, 0, nullptr},
+    {WK_TEXT,       BIND_NONE,    WF_LABEL,   WC_WHITE, 0, 0,   -35, 0, 0, 0, 0, "TEMP"},
+    {WK_TEXT,       BIND_NONE,    WF_CAPTION, WC_WHITE, 0, 0,   36,  0, 0, 0, 0, "PRESSURE"},
+    {WK_VALUE,      BIND_PSI,     WF_READOUT, WC_WHITE, WIDGET_ALARM_COLOR, 0, 68, 0, 0, 0, 0, "%s"},
+    {WK_TEXT,       BIND_NONE,    WF_LABEL,   WC_WHITE, 0, 0,   100, 0, 0, 0, 0, "PSI"},
+    {WK_VALUE,      BIND_PSI_MIN, WF_CAPTION, WC_GREY,  0, -62, 68,  0, 0, 0, 0, "LO\n%s"},
+    {WK_VALUE,      BIND_PSI_MAX, WF_CAPTION, WC_GREY,  0, 62,  68,  0, 0, 0, 0, "HI\n%s"},
+    {WK_FAULT,      BIND_SENSOR_FAULT, WF_CAPTION, WC_WARNING, 0, 0, 14, 0, 0, 0, 0, "SENSOR %s"},
+};
+
+// Large pressure bar with the envelope's expected minimum and engine speed
+static const WidgetDesc BAR_WIDGETS[] = {
+    {WK_TEXT,  BIND_NONE,         WF_LABEL,   WC_WHITE, 0, 0, -80, 0, 0, 0, 0, "OIL PSI"},
+    {WK_VALUE, BIND_PSI,          WF_READOUT, WC_WHITE, WIDGET_ALARM_COLOR, 0, -35, 0, 0, 0, 0, "%s"},
+    {WK_BAR,   BIND_PSI,          WF_CAPTION, WC_WHITE, WIDGET_ALARM_COLOR, 0, 15, 190, 24, 0, 100, nullptr},
+    {WK_VALUE, BIND_EXPECTED_PSI, WF_CAPTION, WC_GREY,  0, 0, 45,  0, 0, 0, 0, "EXPECTED %s"},
+    {WK_VALUE, BIND_RPM,          WF_LABEL,   WC_WHITE, 0, 0, 80,  0, 0, 0, 0, "%s RPM"},
+    {WK_FAULT, BIND_SENSOR_FAULT, WF_CAPTION, WC_WARNING, 0, 0, 100, 0, 0, 0, 0, "SENSOR %s"},
+};
+
+// Session and 10 s statistics
+static const WidgetDesc MINMAX_WIDGETS[] = {
+    {WK_TEXT,  BIND_NONE,        WF_LABEL,   WC_WHITE, 0, 0,   -85, 0, 0, 0, 0, "MIN / MAX"},
+    {WK_TEXT,  BIND_NONE,        WF_CAPTION, WC_GREY,  0, 0,   -55, 0, 0, 0, 0, "OIL PSI"},
+    {WK_VALUE, BIND_PSI_MIN,     WF_READOUT, WC_WHITE, 0, -50, -20, 0, 0, 0, 0, "%s"},
+    {WK_VALUE, BIND_PSI_MAX,     WF_READOUT, WC_WHITE, 0, 50,  -20, 0, 0, 0, 0, "%s"},
+    {WK_VALUE, BIND_PSI_AVG_10S, WF_CAPTION, WC_GREY,  0, 0,   15,  0, 0, 0, 0, "10S AVG %s"},
+    {WK_TEXT,  BIND_NONE,        WF_CAPTION, WC_GREY,  0, 0,   45,  0, 0, 0, 0, "TEMP F"},
+    {WK_VALUE, BIND_TEMP_MIN_F,  WF_LABEL,   WC_WHITE, 0, -40, 70,  0, 0, 0, 0, "%s"},
+    {WK_VALUE, BIND_TEMP_MAX_F,  WF_LABEL,   WC_WHITE, 0, 40,  70,  0, 0, 0, 0, "%s"},
+};
+
+// Alarm history
+static const WidgetDesc ALARM_WIDGETS[] = {
+    {WK_TEXT,       BIND_NONE,        WF_LABEL,   WC_WHITE, 0, 0, -85, 0, 0, 0, 0, "ALARMS"},
+    {WK_ALARM_LIST, BIND_ALARM_COUNT, WF_CAPTION, WC_WHITE, 0, 0, 5,   180, 140, 0, 0, "NO ALARMS"},
+};
+
+// Per-screen LVGL pool budgets (bytes). /screens reports actual use so these
+// can be tightened after a layout change. The bar screen's budget includes
+// the lv_bar object with its indicator animation state and two local styles
+// (track and indicator colour), about 400 bytes over a label.
+#define SCREEN_BUDGET_GAUGE  6144
+#define SCREEN_BUDGET_BAR    3584
+#define SCREEN_BUDGET_MINMAX 3072
+#define SCREEN_BUDGET_ALARMS 2048
+#define SCREEN_BUDGET_TOTAL (SCREEN_BUDGET_GAUGE + SCREEN_BUDGET_BAR + SCREEN_BUDGET_MINMAX + SCREEN_BUDGET_ALARMS)
+
+#define SCREEN_ENTRY(name, widgets, budget) {name, widgets, sizeof(widgets) / sizeof(widgets[0]), budget}
+
+// Index order is the cfg.screen value
+static const ScreenDesc SCREENS[] = {
+    SCREEN_ENTRY("gauge",  GAUGE_WIDGETS,  SCREEN_BUDGET_GAUGE),
+    SCREEN_ENTRY("bar",    BAR_WIDGETS,    SCREEN_BUDGET_BAR),
+    SCREEN_ENTRY("minmax", MINMAX_WIDGETS, SCREEN_BUDGET_MINMAX),
+    SCREEN_ENTRY("alarms", ALARM_WIDGETS,  SCREEN_BUDGET_ALARMS),
+};
+#define SCREEN_COUNT ((int)(sizeof(SCREENS) / sizeof(SCREENS[0])))
+
+#endif // SCREEN_LAYOUT_H
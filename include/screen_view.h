@@ -0,0 +1,297 @@
+#ifndef SCREEN_VIEW_H
+#define SCREEN_VIEW_H
+
+#include <lvgl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "gauge_fonts.h"
+#include "gauge_math.h"
+#include "screen_layout.h"
+#include "sensor_diag.h"
+
+// LVGL side of the screen tables in screen_layout.h: builds a screen on
+// first view, keeps it resident and pushes changed values into the active
+// one. Values, time and log output are injected, so the gauge and the
+// headless render tests (test/test_render) run the same layout code.
+
+// White-on-black color scheme
+#define COLOR_ACCENT     lv_color_white()
+#define COLOR_WHITE      lv_color_white()
+#define COLOR_BLACK      lv_color_black()
+#define COLOR_GREY       lv_color_hex(0x606060)
+#define COLOR_NEEDLE     lv_color_white()
+#define COLOR_WARNING    lv_color_hex(0xFF0000)
+
+#define VALUE_UNSET INT32_MIN        // forces the first update of a binding
+#define VALUE_NONE  (INT32_MIN + 1)  // no data yet: shown as "--"
+
+typedef uint32_t (*ViewClockFn)();            // microseconds, free running, wraps
+typedef void (*ViewLogFn)(const char *line);
+
+// Where the screens get what they show
+struct ScreenViewSource {
+    int32_t (*value)(uint8_t binding);           // a WidgetBinding; VALUE_NONE without data
+    bool (*alarm)();                             // pressure below the envelope or sender faulted
+    size_t (*alarmText)(char *buf, size_t len);  // alarm log lines, newest first; 0 if none
+};
+
+struct WidgetState {
+    lv_obj_t *obj;
+    lv_meter_indicator_t *needle;
+    lv_meter_indicator_t *holdArc;
+    int32_t shown;
+    int32_t shownMin;
+    int32_t shownMax;
+    bool shownAlarm;
+};
+
+struct ScreenState {
+    lv_obj_t *scr;
+    WidgetState widgets[SCREEN_MAX_WIDGETS];
+    uint32_t memUsed;        // LVGL pool bytes taken when built
+    uint32_t createUs;
+    uint32_t switches;
+    uint32_t lastSwitchUs;   // load + rebind + first full frame
+    uint32_t maxSwitchUs;
+    uint64_t sumSwitchUs;
+};
+
+static inline const lv_font_t *widgetFont(uint8_t id) {
+    switch (id) {
+        case WF_LABEL:   return FONT_LABEL;
+        case WF_TICKS:   return FONT_TICKS;
+        case WF_READOUT: return FONT_READOUT;
+        default:         return FONT_CAPTION;
+    }
+}
+
+static inline lv_color_t widgetColor(uint8_t id) {
+    switch (id) {
+        case WC_GREY:    return COLOR_GREY;
+        case WC_WARNING: return COLOR_WARNING;
+        default:         return COLOR_WHITE;
+    }
+}
+
+class ScreenView {
+public:
+    ScreenView(const ScreenViewSource &src, ViewClockFn clock, ViewLogFn log)
+        : src(src), clock(clock), log(log) {}
+
+    // Build a screen from its table. Refused if the pool can't cover its
+    // budget; flagged if the built screen ended up over budget.
+    bool create(int idx) {
+        const ScreenDesc &sd = SCREENS[idx];
+        ScreenState &st = screens[idx];
+        if (sd.count > SCREEN_MAX_WIDGETS) {
+            logf("Screen %s: %u widgets, max %d", sd.name, sd.count, SCREEN_MAX_WIDGETS);
+            return false;
+        }
+
+        lv_mem_monitor_t before;
+        lv_mem_monitor(&before);
+        if (before.free_size < sd.memBudget) {
+            logf("Screen %s: %u bytes free, budget %u - not created",
+                 sd.name, (unsigned)before.free_size, (unsigned)sd.memBudget);
+            return false;
+        }
+
+        uint32_t start = clock();
+        st.scr = lv_obj_create(NULL);
+        lv_obj_set_style_bg_color(st.scr, COLOR_BLACK, 0);
+        for (int i = 0; i < sd.count; i++) {
+            createWidget(st.scr, sd.widgets[i], st.widgets[i]);
+        }
+        st.createUs = clock() - start;
+
+        lv_mem_monitor_t after;
+        lv_mem_monitor(&after);
+        st.memUsed = before.free_size - after.free_size;
+        if (st.memUsed > sd.memBudget) {
+            logf("WARNING: screen %s uses %u bytes, budget %u",
+                 sd.name, (unsigned)st.memUsed, (unsigned)sd.memBudget);
+        }
+        return true;
+    }
+
+    // Show a screen, building it on first view. Switch time covers the load,
+    // rebinding and the first full frame, so it is the delay the driver sees;
+    // first-view build time is kept separately in createUs.
+    bool show(int idx) {
+        if (idx == activeIdx) return true;
+        ScreenState &st = screens[idx];
+        if (!st.scr && !create(idx)) return false;
+
+        uint32_t start = clock();
+        lv_scr_load(st.scr);
+        activeIdx = idx;
+        update(true);
+        lv_refr_now(NULL);
+        uint32_t us = clock() - start;
+
+        st.switches++;
+        st.lastSwitchUs = us;
+        st.sumSwitchUs += us;
+        if (us > st.maxSwitchUs) st.maxSwitchUs = us;
+        return true;
+    }
+
+    // Push changed binding values into the active screen's widgets. Widgets
+    // only touch LVGL when what they show changes, so a static screen costs
+    // no redraw. force is used after a switch, when the screen may be stale.
+    void update(bool force) {
+        if (activeIdx < 0) return;
+        const ScreenDesc &sd = SCREENS[activeIdx];
+        ScreenState &st = screens[activeIdx];
+
+        for (int i = 0; i < sd.count; i++) {
+            const WidgetDesc &d = sd.widgets[i];
+            WidgetState &ws = st.widgets[i];
+            if (d.kind == WK_TEXT) continue;
+            if (force) ws.shown = ws.shownMin = ws.shownMax = VALUE_UNSET;
+
+            int32_t v = src.value(d.binding);
+            if (v != ws.shown) {
+                ws.shown = v;
+                if (d.kind == WK_TEMP_METER) {
+                    lv_meter_set_indicator_value(ws.obj, ws.needle, v);
+                } else if (d.kind == WK_BAR) {
+                    lv_bar_set_value(ws.obj, v == VALUE_NONE ? d.rangeMin : v, LV_ANIM_OFF);
+                } else if (d.kind == WK_ALARM_LIST) {
+                    updateAlarmList(ws.obj, d.text);
+                } else if (d.kind == WK_FAULT) {
+                    if (v == SENSOR_OK) lv_label_set_text_static(ws.obj, "");
+                    else lv_label_set_text_fmt(ws.obj, d.text, sensorFaultName(v));
+                } else {
+                    char num[12];
+                    if (v == VALUE_NONE) strcpy(num, "--");
+                    else snprintf(num, sizeof(num), "%ld", (long)v);
+                    lv_label_set_text_fmt(ws.obj, d.text, num);
+                }
+            }
+
+            if (d.kind == WK_TEMP_METER) {
+                int32_t tMin = src.value(BIND_TEMP_MIN_F);
+                int32_t tMax = src.value(BIND_TEMP_MAX_F);
+                if (tMin != VALUE_NONE && tMax != VALUE_NONE &&
+                    (tMin != ws.shownMin || tMax != ws.shownMax)) {
+                    ws.shownMin = tMin;
+                    ws.shownMax = tMax;
+                    lv_meter_set_indicator_start_value(ws.obj, ws.holdArc, tMin);
+                    lv_meter_set_indicator_end_value(ws.obj, ws.holdArc, tMax);
+                }
+            }
+
+            if (d.flags & WIDGET_ALARM_COLOR) {
+                bool alarm = src.alarm();
+                if (force || alarm != ws.shownAlarm) {
+                    ws.shownAlarm = alarm;
+                    lv_color_t c = alarm ? COLOR_WARNING : widgetColor(d.color);
+                    if (d.kind == WK_BAR) lv_obj_set_style_bg_color(ws.obj, c, LV_PART_INDICATOR);
+                    else lv_obj_set_style_text_color(ws.obj, c, 0);
+                }
+            }
+        }
+    }
+
+    int active() const { return activeIdx; }
+    const ScreenState &state(int idx) const { return screens[idx]; }
+
+private:
+    // Temperature scale: 100-260 deg F (2GR-FE oil temp range), 240 deg arc
+    // LVGL rotation: 0 deg = 3 o'clock, clockwise. 8 o'clock = 150 deg.
+    // 17 ticks (every 10 deg F), major every 4th (every 40 deg F)
+    // Labels: 100, 140, 180, 220, 260
+    static void createTempMeter(lv_obj_t *parent, const WidgetDesc &d, WidgetState &ws) {
+        lv_obj_t *meter = lv_meter_create(parent);
+        lv_obj_set_size(meter, d.w, d.h);
+        lv_obj_set_style_bg_color(meter, COLOR_BLACK, 0);
+        lv_obj_set_style_bg_opa(meter, LV_OPA_COVER, 0);
+        lv_obj_set_style_border_width(meter, 0, 0);
+        lv_obj_set_style_pad_all(meter, 4, 0);
+        lv_obj_set_style_text_font(meter, widgetFont(d.font), LV_PART_TICKS);
+
+        lv_meter_scale_t *scale = lv_meter_add_scale(meter);
+        lv_meter_set_scale_ticks(meter, scale, 17, 2, 10, COLOR_WHITE);
+        lv_meter_set_scale_major_ticks(meter, scale, 4, 3, 16, COLOR_WHITE, 18);
+        lv_meter_set_scale_range(meter, scale, GAUGE_TEMP_MIN_F, GAUGE_TEMP_MAX_F, 240, 150);
+
+        // Session min/max temperature hold band, drawn under the needle
+        ws.holdArc = lv_meter_add_arc(meter, scale, 3, COLOR_GREY, -12);
+        lv_meter_set_indicator_start_value(meter, ws.holdArc, GAUGE_TEMP_MIN_F);
+        lv_meter_set_indicator_end_value(meter, ws.holdArc, GAUGE_TEMP_MIN_F);
+
+        // Red needle from center to tick edge
+        ws.needle = lv_meter_add_needle_line(meter, scale, 3, COLOR_WARNING, -4);
+        lv_meter_set_indicator_value(meter, ws.needle, GAUGE_TEMP_MIN_F);
+
+        // Red center pivot dot
+        lv_obj_set_style_size(meter, 12, LV_PART_INDICATOR);
+        lv_obj_set_style_bg_color(meter, COLOR_WARNING, LV_PART_INDICATOR);
+        lv_obj_set_style_bg_opa(meter, LV_OPA_COVER, LV_PART_INDICATOR);
+
+        ws.obj = meter;
+    }
+
+    static void createWidget(lv_obj_t *parent, const WidgetDesc &d, WidgetState &ws) {
+        ws = {};
+        ws.shown = VALUE_UNSET;
+        ws.shownMin = VALUE_UNSET;
+        ws.shownMax = VALUE_UNSET;
+
+        switch (d.kind) {
+            case WK_TEMP_METER:
+                createTempMeter(parent, d, ws);
+                break;
+            case WK_BAR:
+                ws.obj = lv_bar_create(parent);
+                lv_obj_set_size(ws.obj, d.w, d.h);
+                lv_bar_set_range(ws.obj, d.rangeMin, d.rangeMax);
+                lv_obj_set_style_bg_color(ws.obj, COLOR_GREY, LV_PART_MAIN);
+                lv_obj_set_style_bg_color(ws.obj, widgetColor(d.color), LV_PART_INDICATOR);
+                break;
+            default:
+                ws.obj = lv_label_create(parent);
+                lv_obj_set_style_text_font(ws.obj, widgetFont(d.font), 0);
+                lv_obj_set_style_text_color(ws.obj, widgetColor(d.color), 0);
+                lv_obj_set_style_text_align(ws.obj, LV_TEXT_ALIGN_CENTER, 0);
+                if (d.kind == WK_TEXT || d.kind == WK_ALARM_LIST) {
+                    lv_label_set_text_static(ws.obj, d.text);
+                } else {
+                    lv_label_set_text(ws.obj, "");
+                }
+                if (d.w > 0) {
+                    lv_obj_set_size(ws.obj, d.w, d.h > 0 ? d.h : LV_SIZE_CONTENT);
+                }
+                break;
+        }
+        lv_obj_align(ws.obj, LV_ALIGN_CENTER, d.x, d.y);
+    }
+
+    void updateAlarmList(lv_obj_t *label, const char *emptyText) {
+        char text[ALARM_LIST_LINES * 24];
+        if (src.alarmText(text, sizeof(text)) == 0) {
+            lv_label_set_text_static(label, emptyText);
+        } else {
+            lv_label_set_text(label, text);
+        }
+    }
+
+    void logf(const char *fmt, ...) {
+        char line[96];
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(line, sizeof(line), fmt, args);
+        va_end(args);
+        log(line);
+    }
+
+    ScreenViewSource src;
+    ViewClockFn clock;
+    ViewLogFn log;
+    ScreenState screens[SCREEN_COUNT] = {};
+    int activeIdx = -1;
+};
+
+#endif // SCREEN_VIEW_H
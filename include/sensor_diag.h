@@ -0,0 +1,124 @@
+#ifndef SENSOR_DIAG_H
+#define SENSOR_DIAG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rolling_stats.h"
+
+// Oversampled pressure acquisition plus sender fault diagnostics.
+//
+// Each acquisition is a burst of 4^OVERSAMPLE_BITS raw ADC reads. Their sum
+// decimated by 2^OVERSAMPLE_BITS gives OVERSAMPLE_BITS extra bits of
+// resolution (the ADC's own noise acts as dither); the burst's raw min/max
+// feed the diagnostics. Classification is a handful of compares per burst,
+// so it runs on every sample.
+
+#define OVERSAMPLE_BITS    2
+#define OVERSAMPLE_SAMPLES (1u << (2 * OVERSAMPLE_BITS))
+
+struct AdcBurst {
+    uint32_t sum;
+    uint16_t lo;
+    uint16_t hi;
+    uint16_t n;
+
+    void reset() { sum = 0; lo = UINT16_MAX; hi = 0; n = 0; }
+
+    void add(uint16_t raw) {
+        sum += raw;
+        if (raw < lo) lo = raw;
+        if (raw > hi) hi = raw;
+        n++;
+    }
+
+    // (12 + OVERSAMPLE_BITS)-bit result
+    uint32_t decimated() const { return sum >> OVERSAMPLE_BITS; }
+    // Same value on the 12-bit scale, with fractional bits kept
+    float counts() const { return (float)decimated() / (1u << OVERSAMPLE_BITS); }
+    uint16_t span() const { return n ? hi - lo : 0; }
+};
+
+enum SensorFault : uint8_t {
+    SENSOR_OK,
+    SENSOR_OPEN,          // signal line open: divider pulls it to 0 V
+    SENSOR_SHORT_GND,
+    SENSOR_SHORT_SUPPLY,  // pinned at or above the top of the sender's range
+    SENSOR_STUCK,         // no movement at all over the stuck window
+    SENSOR_NOISY          // burst spread far beyond normal ADC noise
+};
+
+static inline const char *sensorFaultName(uint8_t f) {
+    switch (f) {
+        case SENSOR_OK:           return "OK";
+        case SENSOR_OPEN:         return "OPEN";
+        case SENSOR_SHORT_GND:    return "SHORT GND";
+        case SENSOR_SHORT_SUPPLY: return "SHORT VCC";
+        case SENSOR_STUCK:        return "STUCK";
+        case SENSOR_NOISY:        return "NOISY";
+        default:                  return "?";
+    }
+}
+
+// Thresholds in raw 12-bit counts at the ADC pin
+struct SensorLimits {
+    uint16_t lowRaw;        // every sample below: under range (open or short to ground)
+    uint16_t highRaw;       // every sample above: short to supply
+    uint16_t probeOpenRaw;  // pull-up probe reading above this means open, below means short
+    uint16_t noiseSpan;     // burst max - min above this counts as noisy
+    float stuckSpan;        // decimated value moving less than this over the window is stuck
+};
+
+// Reads the pin with its internal pull-up briefly enabled. Only called while
+// the signal is under range, so it costs nothing in normal running.
+typedef uint16_t (*SensorProbeFn)();
+
+// A fault is reported after CONFIRM consecutive bursts agree and cleared
+// after CLEAR healthy ones; STUCK_N is the stuck window in bursts.
+template <size_t STUCK_N, uint8_t CONFIRM = 3, uint8_t CLEAR = 10>
+class SensorDiag {
+public:
+    SensorFault update(const AdcBurst &b, const SensorLimits &lim, SensorProbeFn probe) {
+        SensorFault raw = classify(b, lim, probe);
+
+        if (raw == candidate) {
+            if (count < 255) count++;
+        } else {
+            candidate = raw;
+            count = 1;
+        }
+        if (candidate != SENSOR_OK && count >= CONFIRM) current = candidate;
+        else if (candidate == SENSOR_OK && count >= CLEAR) current = SENSOR_OK;
+        return current;
+    }
+
+    SensorFault fault() const { return current; }
+
+    void reset() {
+        history.reset();
+        candidate = current = SENSOR_OK;
+        count = 0;
+    }
+
+private:
+    SensorFault classify(const AdcBurst &b, const SensorLimits &lim, SensorProbeFn probe) {
+        if (b.lo >= lim.highRaw) return SENSOR_SHORT_SUPPLY;
+        if (b.hi < lim.lowRaw) {
+            history.reset();  // rail readings say nothing about a stuck sender
+            return probe && probe() > lim.probeOpenRaw ? SENSOR_OPEN : SENSOR_SHORT_GND;
+        }
+        if (b.span() > lim.noiseSpan) return SENSOR_NOISY;
+
+        history.push(b.counts());
+        if (history.samples() >= STUCK_N && history.max() - history.min() < lim.stuckSpan) {
+            return SENSOR_STUCK;
+        }
+        return SENSOR_OK;
+    }
+
+    WindowStats<STUCK_N> history;
+    SensorFault candidate = SENSOR_OK;
+    SensorFault current = SENSOR_OK;
+    uint8_t count = 0;
+};
+
+#endif // SENSOR_DIAG_H
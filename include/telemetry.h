@@ -0,0 +1,122 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Binary telemetry framing: fixed-layout record + CRC-16, COBS encoded and
+// terminated by 0x00. A receiver can resync on any zero byte, the CRC
+// rejects damaged frames and the sequence number exposes dropped ones.
+// scripts/telemetry_decode.py is the host-side decoder; keep them in sync.
+
+#define TELEMETRY_VERSION 1
+
+// Little-endian on the wire (both ESP32 and host decoders are LE)
+struct __attribute__((packed)) TelemetryRecord {
+    uint8_t version;
+    uint8_t flags;          // TELEM_FLAG_*
+    uint16_t seq;           // wraps; gaps mean dropped records
+    uint32_t timeUs;        // micros() at sampling
+    uint16_t adcRaw;        // single raw ADC read (0 when simulated)
+    int16_t psiX100;        // instantaneous pressure
+    int16_t psiFilteredX100;
+    int16_t tempCX10;
+    uint16_t rpm;
+};
+
+#define TELEM_FLAG_SIMULATED   0x01
+#define TELEM_FLAG_LOW_PRESS   0x02   // below the expected-pressure envelope
+#define TELEM_FLAG_SENSOR_FAULT 0x04  // pressure sender faulted; psi fields are not valid
+
+// Payload + CRC, plus worst-case COBS overhead and the delimiter
+#define TELEMETRY_RAW_LEN   (sizeof(TelemetryRecord) + 2)
+#define TELEMETRY_FRAME_MAX (TELEMETRY_RAW_LEN + TELEMETRY_RAW_LEN / 254 + 2)
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+static inline uint16_t crc16Ccitt(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// COBS-encode len bytes into out (no trailing delimiter); returns encoded length
+static inline size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t codeIdx = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[codeIdx] = code;
+            codeIdx = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[codeIdx] = code;
+                codeIdx = o++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIdx] = code;
+    return o;
+}
+
+// Build a complete wire frame (COBS + 0x00); returns its length
+static inline size_t telemetryFrame(const TelemetryRecord &rec, uint8_t out[TELEMETRY_FRAME_MAX]) {
+    uint8_t raw[TELEMETRY_RAW_LEN];
+    memcpy(raw, &rec, sizeof(rec));
+    uint16_t crc = crc16Ccitt(raw, sizeof(rec));
+    raw[sizeof(rec)] = crc & 0xFF;
+    raw[sizeof(rec) + 1] = crc >> 8;
+    size_t n = cobsEncode(raw, sizeof(raw), out);
+    out[n++] = 0x00;
+    return n;
+}
+
+// Fixed-size byte ring for non-blocking transmit. Frames are queued whole or
+// not at all, so a full ring drops records rather than splitting them.
+template <size_t N>
+class TxRing {
+public:
+    bool push(const uint8_t *data, size_t len) {
+        if (len > N - used) {
+            dropped++;
+            return false;
+        }
+        for (size_t i = 0; i < len; i++) {
+            buf[(head + used + i) % N] = data[i];
+        }
+        used += len;
+        return true;
+    }
+
+    // Longest contiguous run available to send from the front
+    size_t peek(const uint8_t **data) const {
+        *data = buf + head;
+        size_t run = N - head;
+        return used < run ? used : run;
+    }
+
+    void consume(size_t len) {
+        head = (head + len) % N;
+        used -= len;
+    }
+
+    size_t size() const { return used; }
+    uint32_t droppedFrames() const { return dropped; }
+
+private:
+    uint8_t buf[N];
+    size_t head = 0;
+    size_t used = 0;
+    uint32_t dropped = 0;
+};
+
+#endif // TELEMETRY_H
@@ -16,54 +16,132 @@ h2{font-size:1em;color:#aaa;padding:10px 0 6px;border-bottom:1px solid #333;marg
 .f label{flex:1;font-size:0.9em}
 .f input[type=number]{width:100px;padding:4px 6px;background:#2a2a2a;color:#fff;border:1px solid #555;border-radius:4px;font-size:0.9em}
 .f input[type=checkbox]{width:20px;height:20px}
+.f input[type=text]{width:60%;padding:4px 6px;background:#2a2a2a;color:#fff;border:1px solid #555;border-radius:4px;font-size:0.8em}
+.f input[type=file]{max-width:60%;font-size:0.8em}
 .btn{display:block;width:100%;padding:12px;margin:18px 0 8px;background:#2196F3;color:#fff;border:none;border-radius:6px;font-size:1em;cursor:pointer}
 .btn:active{background:#1976D2}
 .rst{background:#f44336}.rst:active{background:#c62828}
 .msg{text-align:center;padding:8px;margin:8px 0;border-radius:4px;display:none}
 .ok{background:#2e7d32;display:block}
+.err{background:#c62828;display:block}
+.st{width:100%;border-collapse:collapse;font-size:0.85em;margin-top:6px}
+.st td,.st th{padding:4px;text-align:right;border-bottom:1px solid #333}
+.st input{width:56px;padding:2px 4px;background:#2a2a2a;color:#fff;border:1px solid #555;border-radius:4px}
+.st th:first-child,.st td:first-child{text-align:left}
 .foot{text-align:center;color:#666;font-size:0.75em;padding:12px 0}
+.live{text-align:center;font-size:1.1em;padding:8px 0}
 </style>
 </head>
 <body>
 <h1>SW20 Gauge Config</h1>
 <div id="msg" class="msg"></div>
-<form method="POST" action="/save">
+<div id="live" class="live">--</div>
 
 <h2>Simulation</h2>
-<div class="f"><label>Simulated Oil Pressure</label><input type="checkbox" name="simData" %SIM_DATA%></div>
-<div class="f"><label>Simulated Temperature</label><input type="checkbox" name="simTemp" %SIM_TEMP%></div>
-<div class="f"><label>Simulated Headlight</label><input type="checkbox" name="simHL" %SIM_HL%></div>
+<div class="f"><label>Simulated Oil Pressure</label><input type="checkbox" data-k="simData"></div>
+<div class="f"><label>Simulated Temperature</label><input type="checkbox" data-k="simTemp"></div>
+<div class="f"><label>Simulated Headlight</label><input type="checkbox" data-k="simHL"></div>
+<div class="f"><label>Simulated RPM</label><input type="checkbox" data-k="simRpm"></div>
 
 <h2>Sensor Calibration</h2>
-<div class="f"><label>Min Voltage (V)</label><input type="number" name="sensMinV" step="0.01" value="%SENS_MIN_V%"></div>
-<div class="f"><label>Max Voltage (V)</label><input type="number" name="sensMaxV" step="0.01" value="%SENS_MAX_V%"></div>
-<div class="f"><label>Max PSI</label><input type="number" name="sensMaxP" step="0.1" value="%SENS_MAX_P%"></div>
-<div class="f"><label>Divider R1 (&Omega;)</label><input type="number" name="vdR1" step="1" value="%VD_R1%"></div>
-<div class="f"><label>Divider R2 (&Omega;)</label><input type="number" name="vdR2" step="1" value="%VD_R2%"></div>
+<div class="f"><label>Min Voltage (V)</label><input type="number" data-k="sensMinV" step="0.01"></div>
+<div class="f"><label>Max Voltage (V)</label><input type="number" data-k="sensMaxV" step="0.01"></div>
+<div class="f"><label>Max PSI</label><input type="number" data-k="sensMaxP" min="10" max="300" step="0.1"></div>
+<div class="f"><label>Divider R1 (&Omega;)</label><input type="number" data-k="vdR1" step="1"></div>
+<div class="f"><label>Divider R2 (&Omega;)</label><input type="number" data-k="vdR2" step="1"></div>
 
 <h2>Safety Thresholds</h2>
-<div class="f"><label>Oil Min Safe (PSI)</label><input type="number" name="oilSafe" step="0.1" value="%OIL_SAFE%"></div>
-<div class="f"><label>Oil Min Warn (PSI)</label><input type="number" name="oilWarn" step="0.1" value="%OIL_WARN%"></div>
-<div class="f"><label>Temp Warning (&deg;C)</label><input type="number" name="tempWarn" step="0.1" value="%TEMP_WARN%"></div>
+<div class="f"><label>Oil Min Safe (PSI)</label><input type="number" data-k="oilSafe" step="0.1"></div>
+<div class="f"><label>Oil Min Warn (PSI)</label><input type="number" data-k="oilWarn" step="0.1"></div>
+<div class="f"><label>Temp Warning (&deg;C)</label><input type="number" data-k="tempWarn" step="0.1"></div>
+
+<h2>Expected Pressure (min PSI)</h2>
+<div class="f"><label>Tach Pulses / Rev</label><input type="number" data-k="tachPPR" step="0.5"></div>
+<div class="f"><label>Oil Temp Without Sender (&deg;C)</label><input type="number" data-k="envTempC" min="20" max="120" step="1"></div>
+<table class="st" id="env"></table>
 
 <h2>Backlight</h2>
-<div class="f"><label>Day Brightness (0-255)</label><input type="number" name="blDay" min="0" max="255" value="%BL_DAY%"></div>
-<div class="f"><label>Night Brightness (0-255)</label><input type="number" name="blNight" min="0" max="255" value="%BL_NIGHT%"></div>
-<div class="f"><label>Fade Duration (ms)</label><input type="number" name="blFade" min="0" max="5000" value="%BL_FADE%"></div>
+<div class="f"><label>Day Brightness (0-255)</label><input type="number" data-k="blDay" min="0" max="255"></div>
+<div class="f"><label>Night Brightness (0-255)</label><input type="number" data-k="blNight" min="0" max="255"></div>
+<div class="f"><label>Fade Duration (ms)</label><input type="number" data-k="blFade" min="0" max="5000"></div>
 
 <h2>Display</h2>
-<div class="f"><label>EMA Smoothing (0.01-1.0)</label><input type="number" name="emaAlpha" step="0.01" min="0.01" max="1.0" value="%EMA_ALPHA%"></div>
+<div class="f"><label>EMA Smoothing (0.01-1.0)</label><input type="number" data-k="emaAlpha" step="0.01" min="0.01" max="1.0"></div>
+<div class="f"><label>Screen (0=gauge, 1=bar, 2=min/max, 3=alarms)</label><input type="number" data-k="screen" min="0" max="3"></div>
 
-<button class="btn" type="submit">Save &amp; Apply</button>
-</form>
-<form method="POST" action="/reset">
-<button class="btn rst" type="submit" onclick="return confirm('Reset all settings to factory defaults?')">Reset to Defaults</button>
+<h2>Diagnostics</h2>
+<div class="f"><label>Heap Frag Warning (%)</label><input type="number" data-k="memFrag" min="1" max="100"></div>
+<div class="f"><label>Binary Telemetry (Hz, 0=off)</label><input type="number" data-k="telemHz" min="0" max="1000" step="50"></div>
+<p class="foot" id="mem">--</p>
+
+<h2>WiFi</h2>
+<div class="f"><label>AP Idle Shutdown (s)</label><input type="number" data-k="apIdle" min="30" max="3600"></div>
+<p class="foot" id="wifi">--</p>
+
+<h2>Power</h2>
+<div class="f"><label>Mode (0=full clock, 1=DFS, 2=DFS+sleep; reboot)</label><input type="number" data-k="pmMode" min="0" max="2"></div>
+<p class="foot" id="power">--</p>
+
+<h2>Statistics (min / avg / max)</h2>
+<table class="st">
+<tr><th></th><th>Oil (PSI)</th><th>Temp (&deg;C)</th></tr>
+<tr><td>1 s</td><td id="psi1s"></td><td id="temp1s"></td></tr>
+<tr><td>10 s</td><td id="psi10s"></td><td id="temp10s"></td></tr>
+<tr><td>Session</td><td id="psiSession"></td><td id="tempSession"></td></tr>
+</table>
+<button class="btn" onclick="post('/stats/reset')">Reset Session Min/Max</button>
+
+<h2>Firmware Update</h2>
+<form method="POST" action="/update" enctype="multipart/form-data" onsubmit="this.action='/update?sha256='+this.sha.value.trim()">
+<div class="f"><label>Image (.bin)</label><input type="file" name="fw" accept=".bin" required></div>
+<div class="f"><label>SHA-256</label><input type="text" name="sha" pattern="[0-9a-fA-F]{64}" required></div>
+<button class="btn" type="submit">Upload &amp; Reboot</button>
 </form>
-<p class="foot">SW20 Cluster Gauge &bull; 192.168.4.1</p>
+
+<button class="btn rst" onclick="if(confirm('Reset all settings to factory defaults?'))post('/reset',1)">Reset to Defaults</button>
+<p class="foot">SW20 Cluster Gauge &bull; 192.168.4.1 &bull; changes apply instantly</p>
 <script>
-var p=location.search;
-if(p==='?saved=1'){var m=document.getElementById('msg');m.textContent='Settings saved!';m.className='msg ok';setTimeout(function(){m.style.display='none'},3000)}
-if(p==='?reset=1'){var m=document.getElementById('msg');m.textContent='Defaults restored!';m.className='msg ok';setTimeout(function(){m.style.display='none'},3000)}
+var cfg={},msgT;
+function $(id){return document.getElementById(id)}
+function show(t,bad){var m=$('msg');m.textContent=t;m.className='msg '+(bad?'err':'ok');clearTimeout(msgT);msgT=setTimeout(function(){m.className='msg'},2000)}
+function fill(c){
+  cfg=c;
+  document.querySelectorAll('[data-k]').forEach(function(e){
+    var v=c[e.dataset.k];
+    if(e.type=='checkbox')e.checked=v;else if(document.activeElement!==e)e.value=+v.toFixed(3);
+  });
+  var h='<tr><th>RPM</th>';
+  c.envTemp.forEach(function(t){h+='<th>'+t+'&deg;C</th>'});
+  c.envRpm.forEach(function(r,i){
+    h+='</tr><tr><td>'+r+'</td>';
+    c.envelope[i].forEach(function(v,j){h+='<td><input type="number" step="0.5" data-r="'+i+'" data-t="'+j+'" value="'+v+'"></td>'});
+  });
+  $('env').innerHTML=h+'</tr>';
+}
+function req(m,u,b){
+  return fetch(u,{method:m,headers:{'Content-Type':'application/json'},body:b}).then(function(r){
+    return r.ok?(r.status==204?null:r.json()):r.text().then(function(t){throw t});
+  });
+}
+function patch(o){req('PATCH','/api/config',JSON.stringify(o)).then(function(c){fill(c);show('Saved')}).catch(function(e){show(e,1)})}
+function post(u,isCfg){req('POST',u).then(function(c){if(isCfg){fill(c);show('Defaults restored')}else show('Done');poll()}).catch(function(e){show(e,1)})}
+document.addEventListener('change',function(ev){
+  var e=ev.target,o={};
+  if(e.dataset.k){o[e.dataset.k]=e.type=='checkbox'?e.checked:+e.value;patch(o)}
+  else if(e.dataset.r){var env=cfg.envelope.map(function(r){return r.slice()});env[e.dataset.r][e.dataset.t]=+e.value;patch({envelope:env})}
+});
+function fmt(s){return s.n?s.min.toFixed(1)+' / '+s.avg.toFixed(1)+' / '+s.max.toFixed(1):'--'}
+function poll(){
+  req('GET','/api/status').then(function(s){
+    $('live').textContent=(s.sensorFault!='OK'?'SENSOR '+s.sensorFault:s.psi.toFixed(0)+' PSI')+' \u2022 '+s.tempC.toFixed(0)+'\u00b0C \u2022 '+s.rpm+' RPM'+(s.lowForConditions?' \u2022 LOW':'');
+    for(var k in s.stats)$(k).textContent=fmt(s.stats[k]);
+    var w=s.wifi;$('wifi').textContent='AP up '+w.apUptime+' s, '+w.clients+' client(s) \u2022 loop mean/max: radio off '+w.loopRadioOff.meanUs+'/'+w.loopRadioOff.maxUs+' \u00b5s, on '+w.loopRadioOn.meanUs+'/'+w.loopRadioOn.maxUs+' \u00b5s';
+    var p=s.power;$('power').textContent='Mode '+p.mode+' \u2022 busy '+p.busyPct.toFixed(1)+'% \u2022 wake late mean/max '+p.wakeLateMeanUs+'/'+p.wakeLateMaxUs+' \u00b5s ['+p.wakeLateHist.join(' ')+']';
+    if(s.mem)$('mem').textContent='LVGL '+(s.mem.lvUsed>>10)+'K used, '+s.mem.lvFrag+'% frag \u2022 Heap '+(s.mem.heapFree>>10)+'K free, '+s.mem.heapFrag+'% frag';
+  }).catch(function(){});
+}
+req('GET','/api/config').then(fill);
+poll();setInterval(poll,1000);
 </script>
 </body>
 </html>
@@ -0,0 +1,109 @@
+"""
+PlatformIO pre-build script: generate glyph-subsetted LVGL fonts and report
+the flash each font costs.
+
+Only the characters the gauge actually draws are converted (see FONTS), which
+keeps the big 48pt readout down to digits plus the splash logo. Generated
+sources go to src/fonts/ and are rebuilt only when their spec changes.
+
+Needs lv_font_conv (npm i -g lv_font_conv), or set LV_FONT_CONV to its path.
+Without it the build falls back to LVGL's built-in Montserrat fonts.
+"""
+
+import json
+import os
+import shutil
+import subprocess
+
+Import("env")
+
+# (symbol name, point size, characters drawn at that size)
+FONTS = [
+    ("gauge_font_12", 12, "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-:/ "),  # captions, hold, alarm list
+    ("gauge_font_16", 16, "0123456789"),                # meter tick labels
+    ("gauge_font_48", 48, "0123456789-MR"),             # pressure readout, logo
+]
+FONT_BPP = 4
+
+PROJECT_DIR = env.subst("$PROJECT_DIR")
+FONT_DIR = os.path.join(PROJECT_DIR, "src", "fonts")
+STAMP_FILE = os.path.join(FONT_DIR, ".stamp.json")
+TTF_PATH = os.path.join(env.subst("$PROJECT_LIBDEPS_DIR"), env.subst("$PIOENV"),
+                        "lvgl", "scripts", "built_in_font", "Montserrat-Medium.ttf")
+
+
+def find_converter():
+    path = os.environ.get("LV_FONT_CONV") or shutil.which("lv_font_conv")
+    return [path] if path else None
+
+
+def font_spec(size, chars):
+    return {"size": size, "chars": "".join(sorted(set(chars))), "bpp": FONT_BPP}
+
+
+def generate_fonts(conv):
+    try:
+        with open(STAMP_FILE) as f:
+            stamp = json.load(f)
+    except (OSError, ValueError):
+        stamp = {}
+
+    os.makedirs(FONT_DIR, exist_ok=True)
+    for name, size, chars in FONTS:
+        spec = font_spec(size, chars)
+        out = os.path.join(FONT_DIR, name + ".c")
+        if stamp.get(name) == spec and os.path.isfile(out):
+            continue
+        print("font_subset: generating %s (%dpt, %d glyphs)" % (name, size, len(spec["chars"])))
+        subprocess.check_call(conv + [
+            "--font", TTF_PATH, "--symbols", spec["chars"],
+            "--size", str(size), "--bpp", str(FONT_BPP),
+            "--format", "lvgl", "--no-compress",
+            "--lv-font-name", name, "-o", out,
+        ])
+        stamp[name] = spec
+
+    with open(STAMP_FILE, "w") as f:
+        json.dump(stamp, f, indent=2, sort_keys=True)
+
+
+def object_flash_bytes(obj):
+    # Sum of allocated read-only/data sections; fonts are all const data
+    sizetool = env.subst("$SIZETOOL")
+    out = subprocess.check_output([sizetool, "-A", obj]).decode()
+    total = 0
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[0].startswith((".rodata", ".data")) and parts[1].isdigit():
+            total += int(parts[1])
+    return total
+
+
+def font_report(source, target, env):
+    build_dir = env.subst("$BUILD_DIR")
+    rows = []
+    for root, _, files in os.walk(build_dir):
+        for fn in files:
+            if fn.endswith(".c.o") and ("gauge_font_" in fn or "lv_font_montserrat_" in fn):
+                size = object_flash_bytes(os.path.join(root, fn))
+                if size:
+                    rows.append((fn[:-4], size))
+
+    rows.sort(key=lambda r: -r[1])
+    lines = ["Font flash budget", "-----------------"]
+    lines += ["%-28s %8d bytes" % r for r in rows]
+    lines.append("%-28s %8d bytes" % ("total", sum(r[1] for r in rows)))
+    report = "\n".join(lines)
+    print(report)
+    with open(os.path.join(build_dir, "font_report.txt"), "w") as f:
+        f.write(report + "\n")
+
+
+conv = find_converter()
+if conv and os.path.isfile(TTF_PATH):
+    generate_fonts(conv)
+    env.Append(CPPDEFINES=[("GAUGE_SUBSET_FONTS", 1)])
+else:
+    print("font_subset: lv_font_conv or Montserrat TTF not found, using built-in fonts")
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", font_report)
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+Decode the gauge's binary telemetry stream (see include/telemetry.h) to CSV.
+
+    telemetry_decode.py /dev/ttyACM0 > drive.csv       # live, needs pyserial
+    telemetry_decode.py capture.bin -o drive.csv       # from a raw capture
+
+Frames are COBS encoded and 0x00 terminated; each carries a CRC-16 and a
+16-bit sequence number. Bad frames and sequence gaps are counted and
+reported on stderr when the stream ends (Ctrl-C for a live port).
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+
+RECORD = struct.Struct("<BBHIHhhhH")
+VERSION = 1
+FLAG_SIMULATED = 0x01
+FLAG_LOW_PRESS = 0x02
+FLAG_SENSOR_FAULT = 0x04
+FIELDS = ["seq", "time_us", "adc_raw", "psi", "psi_filtered", "temp_c", "rpm", "simulated", "low_pressure",
+          "sensor_fault"]
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    def __init__(self, writer):
+        self.writer = writer
+        self.buf = bytearray()
+        self.last_seq = None
+        self.records = 0
+        self.bad = 0
+        self.gaps = 0
+        self.missing = 0
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            end = self.buf.find(b"\x00")
+            if end < 0:
+                return
+            frame = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            if frame:
+                self.frame(frame)
+
+    def frame(self, frame):
+        raw = cobs_decode(frame)
+        if raw is None or len(raw) != RECORD.size + 2:
+            self.bad += 1
+            return
+        payload, crc = raw[:-2], raw[-2] | (raw[-1] << 8)
+        if crc16_ccitt(payload) != crc:
+            self.bad += 1
+            return
+
+        ver, flags, seq, t_us, adc, psi, psi_f, temp, rpm = RECORD.unpack(payload)
+        if ver != VERSION:
+            self.bad += 1
+            return
+
+        if self.last_seq is not None:
+            lost = (seq - self.last_seq - 1) & 0xFFFF
+            if lost:
+                self.gaps += 1
+                self.missing += lost
+                print("gap: %d record(s) missing before seq %d" % (lost, seq), file=sys.stderr)
+        self.last_seq = seq
+        self.records += 1
+
+        self.writer.writerow([seq, t_us, adc, psi / 100.0, psi_f / 100.0, temp / 10.0, rpm,
+                              int(bool(flags & FLAG_SIMULATED)), int(bool(flags & FLAG_LOW_PRESS)),
+                              int(bool(flags & FLAG_SENSOR_FAULT))])
+
+    def summary(self):
+        return "%d records, %d bad frames, %d gaps (%d records missing)" % (
+            self.records, self.bad, self.gaps, self.missing)
+
+
+def open_source(path, baud):
+    if os.path.isfile(path):
+        return open(path, "rb")
+    import serial  # pyserial, only needed for live ports
+    return serial.Serial(path, baud, timeout=0.1)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="serial port or raw capture file")
+    ap.add_argument("-o", "--output", help="CSV output (default stdout)")
+    ap.add_argument("-b", "--baud", type=int, default=115200,
+                    help="ignored by the gauge's USB CDC port; only matters for a UART adapter")
+    args = ap.parse_args()
+
+    src = open_source(args.source, args.baud)
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.writer(out)
+    writer.writerow(FIELDS)
+    dec = Decoder(writer)
+
+    try:
+        while True:
+            data = src.read(4096)
+            if not data:
+                if hasattr(src, "in_waiting"):
+                    continue  # live port: keep waiting
+                break
+            dec.feed(data)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        out.flush()
+        print(dec.summary(), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
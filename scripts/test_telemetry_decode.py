@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Tests for telemetry_decode.py:  python3 -m unittest discover scripts
+
+SAMPLE_FRAME is the frame test/test_telemetry builds from the same record on
+the firmware side, so a framing change has to update both.
+"""
+
+import csv
+import io
+import os
+import sys
+import unittest
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import telemetry_decode as td  # noqa: E402
+
+SAMPLE_FRAME = bytes([
+    0x03, 0x01, 0x02, 0x05, 0x01, 0x40, 0x23, 0x01, 0x01, 0x01, 0x0B,
+    0x9A, 0x10, 0xFB, 0xFF, 0x89, 0x03, 0xB8, 0x0B, 0xF6, 0xCF, 0x00,
+])
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_idx, code = 0, 1
+    for b in data:
+        if b == 0:
+            out[code_idx] = code
+            code_idx, code = len(out), 1
+            out.append(0)
+        else:
+            out.append(b)
+            code += 1
+            if code == 0xFF:
+                out[code_idx] = code
+                code_idx, code = len(out), 1
+                out.append(0)
+    out[code_idx] = code
+    return bytes(out)
+
+
+def frame(seq, psi_x100=1000, flags=0):
+    payload = td.RECORD.pack(td.VERSION, flags, seq, 123456, 2048, psi_x100, psi_x100, 850, 2500)
+    crc = td.crc16_ccitt(payload)
+    return cobs_encode(payload + bytes([crc & 0xFF, crc >> 8])) + b"\x00"
+
+
+def decode(data):
+    out = io.StringIO()
+    dec = td.Decoder(csv.writer(out))
+    stderr, sys.stderr = sys.stderr, io.StringIO()
+    try:
+        dec.feed(data)
+    finally:
+        sys.stderr = stderr
+    return dec, list(csv.reader(io.StringIO(out.getvalue())))
+
+
+class CobsTest(unittest.TestCase):
+    def test_reference_vectors(self):
+        self.assertEqual(td.cobs_decode(bytes([0x01, 0x01])), b"\x00")
+        self.assertEqual(td.cobs_decode(bytes([0x03, 0x11, 0x22, 0x02, 0x33])), bytes([0x11, 0x22, 0x00, 0x33]))
+        self.assertEqual(td.cobs_decode(bytes([0x02, 0x11, 0x01, 0x01, 0x01])), bytes([0x11, 0x00, 0x00, 0x00]))
+
+    def test_long_run_round_trip(self):
+        data = bytes(i % 255 + 1 for i in range(300))
+        self.assertEqual(td.cobs_decode(cobs_encode(data)), data)
+
+    def test_rejects_truncated_final_block(self):
+        self.assertIsNone(td.cobs_decode(bytes([0x03, 0x11, 0x22, 0x02])))
+        self.assertIsNone(td.cobs_decode(bytes([0x05, 0x11, 0x22, 0x33])))
+        self.assertIsNone(td.cobs_decode(SAMPLE_FRAME[:-2]))
+
+    def test_rejects_zero_code(self):
+        self.assertIsNone(td.cobs_decode(bytes([0x02, 0x11, 0x00])))
+
+
+class DecoderTest(unittest.TestCase):
+    def test_firmware_sample_frame(self):
+        dec, rows = decode(SAMPLE_FRAME)
+        self.assertEqual(dec.records, 1)
+        self.assertEqual(dec.bad, 0)
+        self.assertEqual(rows[0], ["256", "74560", "0", "42.5", "-0.05", "90.5", "3000", "0", "1", "0"])
+
+    def test_bad_crc_counted(self):
+        damaged = bytearray(SAMPLE_FRAME)
+        damaged[12] ^= 0x04
+        dec, rows = decode(bytes(damaged))
+        self.assertEqual((dec.records, dec.bad), (0, 1))
+        self.assertEqual(rows, [])
+
+    def test_resyncs_after_garbage(self):
+        dec, _ = decode(b"\x13\x37garbage\x00" + frame(1) + frame(2))
+        self.assertEqual((dec.records, dec.bad, dec.gaps), (2, 1, 0))
+
+    def test_gaps_counted(self):
+        dec, _ = decode(frame(10) + frame(11) + frame(14) + frame(15) + frame(20))
+        self.assertEqual(dec.records, 5)
+        self.assertEqual(dec.gaps, 2)
+        self.assertEqual(dec.missing, 2 + 4)
+
+    def test_gap_across_sequence_wrap(self):
+        dec, _ = decode(frame(0xFFFE) + frame(0xFFFF) + frame(0) + frame(2))
+        self.assertEqual((dec.gaps, dec.missing), (1, 1))
+
+    def test_frame_split_across_reads(self):
+        out = io.StringIO()
+        dec = td.Decoder(csv.writer(out))
+        data = frame(1) + frame(2)
+        for i in range(len(data)):
+            dec.feed(data[i:i + 1])
+        self.assertEqual((dec.records, dec.bad, dec.gaps), (2, 0, 0))
+
+
+if __name__ == "__main__":
+    unittest.main()
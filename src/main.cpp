@@ -5,37 +5,134 @@
 #include <WiFi.h>
 #include <WebServer.h>
 #include <Preferences.h>
+#include <ArduinoJson.h>
+#include <driver/pcnt.h>
+#include <driver/ledc.h>
+#include <driver/gpio.h>
+#include <esp_heap_caps.h>
+#include <esp_ota_ops.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <mbedtls/sha256.h>
 #include "gauge_config.h"
+#include "gauge_math.h"
 #include "web_config_html.h"
+#include "rolling_stats.h"
+#include "gauge_fonts.h"
+#include "double_buffer.h"
+#include "scheduler.h"
+#include "ota_stream.h"
+#include "telemetry.h"
+#include "power_stats.h"
+#include "screen_layout.h"
+#include "screen_view.h"
+#include "sensor_diag.h"
 
 // Create display object (pins configured in platformio.ini)
 TFT_eSPI tft = TFT_eSPI();
 
-// Runtime configuration (loaded from NVS at boot)
-GaugeConfig cfg;
+// Runtime configuration (loaded from NVS at boot). Readers get a copy with
+// config()/configStore.read(); only publishConfig() writes.
+DoubleBuffer<ConfigSnapshot> configStore;
 WebServer server(80);
 Preferences prefs;
 bool wifiReady = false;
+bool configDirty = false;          // published but not yet written to NVS
+unsigned long configEditTime = 0;
 
 // Hardware pin assignments (not configurable)
 #define OIL_PRESSURE_PIN 3  // GPIO3 - ADC1_CH2
 #define HEADLIGHT_PIN 14
+#define TACH_PIN 13
+#define TACH_PCNT_UNIT PCNT_UNIT_0
+#define TACH_FILTER_CYCLES 1000  // ignore glitches shorter than 12.5us (80MHz APB)
 #define BL_PIN 40
-#define BL_PWM_CHANNEL 0
+#define BL_PWM_CHANNEL LEDC_CHANNEL_0
+#define BL_PWM_TIMER LEDC_TIMER_0
+#define BL_PWM_MODE LEDC_LOW_SPEED_MODE  // only mode on ESP32-S3
 #define BL_PWM_FREQ 5000
-#define BL_PWM_RESOLUTION 8
+#define BL_PWM_RESOLUTION LEDC_TIMER_12_BIT
+#define BL_PWM_MAX_DUTY 4095
+#define BL_PWM_FREQ_SLEEP 4000  // RC fast clock source: freq * 4096 must stay under ~17.5 MHz
+#define BL_GAMMA 2.2f
+#define BL_FADE_SEGMENTS 8       // linear hardware ramps chained along the gamma curve
+#define BL_FADE_GRACE_MS 50      // fade-end interrupt overdue: assume it was missed
+#define HEADLIGHT_DEBOUNCE_MS 50
+#define ADC_VREF 3.3f
+#define ADC_MAX_COUNT 4095.0f
+
+// Sender diagnostics (sensor_diag.h). Margins are sender volts outside its
+// rated span. The probe threshold assumes the divider's R2 to ground against
+// the ~45k internal pull-up: an open line reads ~0.6 V, a short ~0.2 V.
+#define SENSOR_FAULT_MARGIN_V 0.25f
+#define SENSOR_RAIL_HIGH_RAW 4080
+#define SENSOR_PROBE_OPEN_V 0.35f
+#define SENSOR_PROBE_SETTLE_US 50
+#define SENSOR_NOISE_SPAN_RAW 200      // normal burst spread is ~20 counts
+#define SENSOR_STUCK_SPAN 0.25f        // one decimated LSB on the 12-bit scale
 
 // Display configuration
 #define SCREEN_WIDTH 240
 #define SCREEN_HEIGHT 240
 
-// White-on-black color scheme
-#define COLOR_ACCENT     lv_color_white()
-#define COLOR_WHITE      lv_color_white()
-#define COLOR_BLACK      lv_color_black()
-#define COLOR_GREY       lv_color_hex(0x606060)
-#define COLOR_NEEDLE     lv_color_white()
-#define COLOR_WARNING    lv_color_hex(0xFF0000)
+// Acquisition rate and statistics windows (in samples)
+#define SAMPLE_INTERVAL_MS 100
+#define STATS_SHORT_SAMPLES (1000 / SAMPLE_INTERVAL_MS)    // 1 s
+#define STATS_LONG_SAMPLES  (10000 / SAMPLE_INTERVAL_MS)   // 10 s
+#define TACH_WINDOW_READS   (500 / SAMPLE_INTERVAL_MS)     // RPM over 500 ms: 40 RPM steps at 3 pulses/rev
+#define SENSOR_STUCK_SAMPLES (5000 / SAMPLE_INTERVAL_MS)   // 5 s without any movement
+
+// Memory monitor: one sample every MEM_SAMPLE_INTERVAL_MS, last MEM_RING_SIZE kept
+#define MEM_SAMPLE_INTERVAL_MS 5000
+#define MEM_RING_SIZE 12
+
+// All screens' budgets plus the boot screen, draw layers and label text
+// must fit the LVGL pool together, since built screens stay resident
+#define SCREEN_POOL_RESERVE (16U * 1024U)
+static_assert(SCREEN_BUDGET_TOTAL + SCREEN_POOL_RESERVE <= LV_MEM_SIZE, "screen budgets exceed LV_MEM_SIZE");
+#define SCREEN_BENCH_MAX_CYCLES 10
+
+// Scheduler job periods (render/network are short so input stays responsive)
+#define RENDER_INTERVAL_MS 10
+#define BACKLIGHT_INTERVAL_MS 20
+#define NETWORK_INTERVAL_MS 10
+#define LOG_INTERVAL_MS 1000
+#define LOG_LINE_MAX 192      // longest text log line (the Mem: line is ~130)
+#define SCHED_MAX_JOBS 12
+
+// Binary telemetry: TX ring sized for ~90 ms of frames at 1 kHz; when off
+// the job idles at TELEMETRY_IDLE_MS
+#define TELEMETRY_RING_SIZE 2048
+#define TELEMETRY_IDLE_MS 100
+
+// Coalesce config edits from the API into one NVS write after this quiet time
+#define NVS_SAVE_DELAY_MS 2000
+
+// On-demand WiFi AP: off at boot, started by AP_TRIGGER_TOGGLES headlight
+// off->on toggles within AP_TRIGGER_WINDOW_MS, or by an on->off->on gesture
+// in the first AP_BOOT_WINDOW_MS after power-up. Headlights that are simply
+// on at power-up never start it. Stops after cfg.apIdleTimeoutS with no
+// stations connected.
+#define AP_TRIGGER_TOGGLES 3
+#define AP_TRIGGER_WINDOW_MS 4000
+#define AP_BOOT_WINDOW_MS 8000
+#define AP_CHECK_INTERVAL_MS 1000
+
+// Power management (cfg.pmMode, applied at boot): DFS between these clocks,
+// plus automatic light sleep in mode 2. The 80 MHz floor keeps APB, and so
+// SPI, LEDC and PCNT timing, fixed.
+#define PM_MAX_CPU_MHZ 240
+#define PM_MIN_CPU_MHZ 80
+
+// OTA: flash writes are one sector at a time; while an upload is streaming
+// the gauge keeps sampling and rendering at this reduced rate
+#define OTA_CHUNK_SIZE 4096
+#define OTA_RENDER_INTERVAL_MS 200
+#define OTA_HEALTH_CHECK_MS 30000  // new image must run cleanly this long
+#define OTA_HEALTH_MIN_RUN_PCT 50     // share of its releases each liveness job must have run
+
+// Consecutive samples below the envelope before flagging (and above to clear)
+#define ENV_DEVIATION_SAMPLES 5
 
 // LVGL display buffer
 static lv_disp_draw_buf_t draw_buf;
@@ -43,95 +140,480 @@ static lv_color_t buf1[SCREEN_WIDTH * 10];
 static lv_color_t buf2[SCREEN_WIDTH * 10];
 static lv_disp_drv_t disp_drv;
 
-// LVGL objects
-static lv_obj_t *meter;
-static lv_meter_indicator_t *needle_temp;
-static lv_obj_t *label_oil_temp;
-static lv_obj_t *label_oil_press;
-static lv_obj_t *label_press_val;
-static lv_obj_t *label_press_unit;
+int requestedScreen = -1;    // last cfg.screen acted on, so a refused switch isn't retried
 
 // Gauge state
 float currentPressure = 0.0;
 float displayPressure = 0.0;
 float currentTemp = 0.0;
 float displayTemp = 0.0;
-unsigned long lastUpdateTime = 0;
+float currentRpm = 0.0;
+
+// Rolling statistics (raw samples, before EMA smoothing)
+RollingStats<STATS_SHORT_SAMPLES, STATS_LONG_SAMPLES> pressureStats;
+RollingStats<STATS_SHORT_SAMPLES, STATS_LONG_SAMPLES> tempStats;
 
 // Simulated data for testing
 float simulatedPressure = 0.0;
 float simulatedTemp = 0.0;
 
-// Backlight fade state
-int currentBrightness = 255;
+// Expected-pressure envelope state
+float expectedPressure = 0.0;
+bool pressureDeviation = false;
+int deviationCount = 0;
+unsigned long lastTachReadTime = 0;
+WindowStats<TACH_WINDOW_READS> tachPulseWindow;   // pulses per read
+WindowStats<TACH_WINDOW_READS> tachTimeWindow;    // ms per read
+
+// Alarm history for the alarms screen: newest at alarmCount - 1
+#define ALARM_LOG_SIZE 8
+#define TEMP_ALARM_HYSTERESIS_C 2.0f
+enum AlarmKind : uint8_t {
+  ALARM_LOW_PRESS,    // below the expected-pressure envelope (value: PSI)
+  ALARM_HIGH_TEMP,    // above cfg.tempWarningHigh (value: deg C)
+  ALARM_SENSOR        // pressure sender fault (value: SensorFault)
+};
+struct AlarmEvent {
+  uint32_t timeS;     // seconds since boot
+  uint8_t kind;
+  int16_t value;
+};
+AlarmEvent alarmLog[ALARM_LOG_SIZE];
+uint32_t alarmCount = 0;
+bool tempAlarm = false;
+
+// Pressure sender diagnostics; while faulted no pressure is shown or recorded
+SensorDiag<SENSOR_STUCK_SAMPLES> pressureDiag;
+SensorFault sensorFault = SENSOR_OK;
+AdcBurst pressureBurst;
+
+// Backlight fade state. The LEDC hardware ramps duty linearly, so a fade is
+// run as BL_FADE_SEGMENTS ramps between gamma-corrected levels; the
+// fade-end interrupt marks each one done and updateBacklight() starts the next.
+static uint16_t blGammaTable[256];
 int targetBrightness = 255;
-int fadeStartBrightness = 255;
-unsigned long fadeStartTime = 0;
+int blLevel = 255;                 // level the running segment ends at
+int blFadeFrom = 255;
+int blFadeTo = 255;
+int blFadeSegment = 0;             // segments started of the current fade
+unsigned long blSegmentEnd = 0;
+volatile bool blSegmentRunning = false;
 bool lastHeadlightState = false;
 
+// Fixed-rate job scheduler driven from loop()
+uint32_t schedClock() { return (uint32_t)micros(); }
+Scheduler<SCHED_MAX_JOBS> scheduler(schedClock);
+unsigned long schedulerStartMs = 0;
+
+// OTA update state
+class EspOtaBackend : public OtaBackend {
+public:
+  bool begin() override {
+    part = esp_ota_get_next_update_partition(NULL);
+    // Erase each sector as the write reaches it rather than the whole
+    // partition up front, which would stall the gauge for seconds
+    return part && esp_ota_begin(part, OTA_WITH_SEQUENTIAL_WRITES, &handle) == ESP_OK;
+  }
+  bool write(const uint8_t *data, size_t len) override {
+    return esp_ota_write(handle, data, len) == ESP_OK;
+  }
+  bool commit() override {
+    // esp_ota_end also validates the image header and app descriptor
+    return esp_ota_end(handle) == ESP_OK && esp_ota_set_boot_partition(part) == ESP_OK;
+  }
+  void abort() override {
+    esp_ota_abort(handle);
+  }
+
+private:
+  const esp_partition_t *part = NULL;
+  esp_ota_handle_t handle = 0;
+};
+
+class MbedtlsSha256 : public OtaHasher {
+public:
+  void begin() override {
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+  }
+  void update(const uint8_t *data, size_t len) override {
+    mbedtls_sha256_update(&ctx, data, len);
+  }
+  void finish(uint8_t out[OTA_SHA256_LEN]) override {
+    mbedtls_sha256_finish(&ctx, out);
+    mbedtls_sha256_free(&ctx);
+  }
+
+private:
+  mbedtls_sha256_context ctx;
+};
+
+EspOtaBackend otaBackend;
+MbedtlsSha256 otaHasher;
+OtaStream<OTA_CHUNK_SIZE> ota(otaBackend, otaHasher);
+bool otaPendingVerify = false;     // running a freshly flashed image
+unsigned long otaRebootAt = 0;
+
+// Binary telemetry state
+TxRing<TELEMETRY_RING_SIZE> telemetryTx;
+uint16_t telemetrySeq = 0;
+int telemetryActiveHz = 0;
+
+// Render statistics from LVGL's monitor callback (one entry per refresh)
+uint32_t renderCount = 0;
+uint32_t renderLastMs = 0;
+uint32_t renderMaxMs = 0;
+uint64_t renderSumMs = 0;
+uint32_t renderLastPx = 0;
+uint32_t renderMaxPx = 0;
+uint64_t renderSumPx = 0;
+
+// Memory monitor samples (LVGL pool and system heap)
+struct MemSample {
+  unsigned long time;
+  uint32_t lvUsed;
+  uint32_t lvFree;
+  uint32_t lvBiggest;
+  uint8_t lvFragPct;
+  uint32_t heapFree;
+  uint32_t heapBiggest;
+  uint8_t heapFragPct;
+};
+MemSample memRing[MEM_RING_SIZE];
+int memRingHead = 0;
+int memRingCount = 0;
+uint32_t lvMaxUsed = 0;        // LVGL pool high-water mark
+uint32_t heapMinFree = 0;      // system heap low-water mark (free bytes)
+bool memFragWarning = false;
+
+// Headlight edge from the GPIO interrupt, settled in updateBacklight()
+volatile bool headlightEdgePending = false;
+volatile unsigned long headlightEdgeTime = 0;
+bool headlightPinState = false;    // debounced input, read even in simulation
+
+// WiFi AP on-demand state
+unsigned long apToggleTimes[AP_TRIGGER_TOGGLES];
+int apToggleHead = 0;
+bool apBootOffSeen = false;          // on->off edge inside AP_BOOT_WINDOW_MS
+const char *apStartRequest = nullptr;  // reason, picked up by wifiJob()
+unsigned long apStartedAt = 0;
+unsigned long apLastClientTime = 0;
+unsigned long apTotalMs = 0;         // completed AP sessions since boot
+uint32_t apStarts = 0;
+
+// Power management: locks keep full clock around display flushes and ADC
+// bursts; sleepLock blocks light sleep while something needs the APB clock
+esp_pm_lock_handle_t flushLock = nullptr;
+esp_pm_lock_handle_t adcLock = nullptr;
+esp_pm_lock_handle_t sleepLock = nullptr;
+bool sleepLockHeld = false;
+int pmActiveMode = PM_MODE_OFF;
+bool blOnApbClock = true;            // backlight PWM stops if the chip light-sleeps
+PowerStats powerStats;
+
+// Time spent in each loop() iteration, split by whether the radio was on
+struct LoopLatency {
+  uint32_t iterations;
+  uint64_t sumUs;
+  uint32_t maxUs;
+
+  void add(uint32_t us) {
+    iterations++;
+    sumUs += us;
+    if (us > maxUs) maxUs = us;
+  }
+  uint32_t meanUs() const { return iterations ? (uint32_t)(sumUs / iterations) : 0; }
+};
+LoopLatency loopLatency[2];  // [0] radio off, [1] radio on
+
 // Function prototypes
 float readOilPressure();
+uint16_t probeSensorPullup();
 float readCoolantTemp();
 float getSimulatedPressure();
 float getSimulatedTemp();
+float readEngineRpm();
+float getSimulatedRpm();
+void initTachCounter();
+void checkPressureEnvelope(float pressure, float rpm, float temp);
+float envelopeTempC();
+void checkTempAlarm(float temp);
+void logPrintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void lvglLog(const char *buf);
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p);
-void createGauge();
-void updateGauge(float pressure, float temp);
+void my_disp_monitor(lv_disp_drv_t *disp, uint32_t time_ms, uint32_t px);
+void handleRender();
+int32_t bindingValue(uint8_t binding);
+bool screenAlarm();
+size_t alarmListText(char *text, size_t size);
+void viewLog(const char *line);
+void followScreenSetting();
+void logAlarm(uint8_t kind, int value);
+void handleScreens();
 void performStartup();
 void updateBacklight();
+void initBacklight(int brightness);
+void setBacklightTarget(int brightness);
+void advanceBacklightFade();
+void IRAM_ATTR onHeadlightEdge();
+bool IRAM_ATTR onBacklightFadeEnd(const ledc_cb_param_t *param, void *arg);
+void sampleMemory();
+void initScheduler();
+void acquireJob();
+void filterJob();
+void renderJob();
+void backlightJob();
+void networkJob();
+void logJob();
+void handleSched();
+void handleUpdateUpload();
+void handleUpdateDone();
+void otaHealthJob();
+bool otaLivenessOk();
+void telemetryJob();
+void handleMem();
+inline GaugeConfig config() { return configStore.read().cfg; }
+void publishConfig(const GaugeConfig &cfg);
 void loadConfigFromNVS();
-void saveConfigToNVS();
+void saveConfigToNVS(const GaugeConfig &cfg);
 void resetConfigToDefaults();
-void initWiFiAP();
-String buildConfigPage();
+void registerWebRoutes();
+void startWiFiAP(const char *reason);
+void stopWiFiAP(const char *reason);
+void noteHeadlightToggle();
+void wifiJob();
+void printLoopLatency();
+void initPowerManagement();
+void updateSleepLock();
+void printPowerStats();
 void handleRoot();
-void handleSave();
+void handleApiConfigGet();
+void handleApiConfigPatch();
+void handleApiStatus();
+void nvsSaveJob();
 void handleReset();
+void handleStatsReset();
 void handleNotFound();
 
+// Screens from the SCREENS tables (include/screen_layout.h), built on first
+// view and kept resident; only the active screen's bindings are updated
+const ScreenViewSource viewSource = {bindingValue, screenAlarm, alarmListText};
+ScreenView view(viewSource, schedClock, viewLog);
+
+// All text logging goes through here. Binary telemetry owns the serial port
+// while it runs, and text interleaved with its frames would corrupt them,
+// so text is dropped until telemetry is switched off again.
+void logPrintf(const char *fmt, ...) {
+  if (telemetryActiveHz) return;
+  char line[LOG_LINE_MAX];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  Serial.print(line);
+}
+
+// LVGL's own warnings (LV_LOG_PRINTF is off)
+void lvglLog(const char *buf) {
+  logPrintf("%s", buf);
+}
+
 // LVGL display flush callback
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p) {
   uint32_t w = lv_area_get_width(area);
   uint32_t h = lv_area_get_height(area);
 
+  if (flushLock) esp_pm_lock_acquire(flushLock);
   tft.startWrite();
   tft.setAddrWindow(area->x1, area->y1, w, h);
   tft.pushColors((uint16_t *)color_p, w * h);
   tft.endWrite();
+  if (flushLock) esp_pm_lock_release(flushLock);
 
   lv_disp_flush_ready(disp);
 }
 
+// LVGL refresh monitor: render+flush time and number of invalidated pixels
+void my_disp_monitor(lv_disp_drv_t *disp, uint32_t time_ms, uint32_t px) {
+  renderCount++;
+  renderLastMs = time_ms;
+  renderSumMs += time_ms;
+  if (time_ms > renderMaxMs) renderMaxMs = time_ms;
+  renderLastPx = px;
+  renderSumPx += px;
+  if (px > renderMaxPx) renderMaxPx = px;
+}
+
 // Read oil pressure from sensor
 float readOilPressure() {
-  if (cfg.useSimulatedData) {
+  if (config().useSimulatedData) {
+    sensorFault = SENSOR_OK;
     return getSimulatedPressure();
   }
 
-  int adcSum = 0;
-  for (int i = 0; i < 10; i++) {
-    adcSum += analogRead(OIL_PRESSURE_PIN);
-    delay(1);
+  // Back-to-back oversampling burst, decimated for OVERSAMPLE_BITS extra bits
+  AdcBurst &b = pressureBurst;
+  b.reset();
+  if (adcLock) esp_pm_lock_acquire(adcLock);
+  for (unsigned i = 0; i < OVERSAMPLE_SAMPLES; i++) {
+    b.add(analogRead(OIL_PRESSURE_PIN));
   }
-  float adcValue = adcSum / 10.0;
-  float measuredVoltage = adcValue * 3.3 / 4095.0;
-  float sensorVoltage = measuredVoltage * (cfg.voltageDividerR1 + cfg.voltageDividerR2) / cfg.voltageDividerR2;
-  float pressure = (sensorVoltage - cfg.sensorMinVoltage) / (cfg.sensorMaxVoltage - cfg.sensorMinVoltage) * cfg.sensorMaxPsi;
+  if (adcLock) esp_pm_lock_release(adcLock);
+
+  const ConfigSnapshot &snap = configStore.read();
+  SensorFault f = pressureDiag.update(b, snap.sensorLimits, probeSensorPullup);
+  if (f != sensorFault) {
+    sensorFault = f;
+    if (f != SENSOR_OK) logAlarm(ALARM_SENSOR, f);
+    logPrintf("Oil pressure sender: %s\n", sensorFaultName(f));
+  }
+  if (f != SENSOR_OK) return 0.0;  // never displayed: the screen shows the fault
 
-  if (pressure < 0) pressure = 0;
-  if (pressure > cfg.sensorMaxPsi) pressure = cfg.sensorMaxPsi;
+  return adcToPsi(b.counts(), snap.psiPerAdcCount, snap.psiOffset, snap.cfg.sensorMaxPsi);
+}
 
-  return pressure;
+// Under-range reading: briefly enable the internal pull-up. An open signal
+// line then rises against R2; a short to ground holds it near 0 V.
+uint16_t probeSensorPullup() {
+  gpio_pullup_en((gpio_num_t)OIL_PRESSURE_PIN);
+  delayMicroseconds(SENSOR_PROBE_SETTLE_US);
+  uint16_t raw = analogRead(OIL_PRESSURE_PIN);
+  gpio_pullup_dis((gpio_num_t)OIL_PRESSURE_PIN);
+  return raw;
 }
 
 // Read coolant temperature (placeholder for real sensor)
 float readCoolantTemp() {
-  if (cfg.useSimulatedTemp) {
+  if (config().useSimulatedTemp) {
     return getSimulatedTemp();
   }
   return 0.0;
 }
 
+// Tach input: PCNT counts rising edges in hardware, we just read and clear
+void initTachCounter() {
+  pcnt_config_t pcntCfg = {};
+  pcntCfg.pulse_gpio_num = TACH_PIN;
+  pcntCfg.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  pcntCfg.channel = PCNT_CHANNEL_0;
+  pcntCfg.unit = TACH_PCNT_UNIT;
+  pcntCfg.pos_mode = PCNT_COUNT_INC;
+  pcntCfg.neg_mode = PCNT_COUNT_DIS;
+  pcntCfg.lctrl_mode = PCNT_MODE_KEEP;
+  pcntCfg.hctrl_mode = PCNT_MODE_KEEP;
+  pcntCfg.counter_h_lim = INT16_MAX;
+  pcntCfg.counter_l_lim = 0;
+  pcnt_unit_config(&pcntCfg);
+
+  pcnt_set_filter_value(TACH_PCNT_UNIT, TACH_FILTER_CYCLES);
+  pcnt_filter_enable(TACH_PCNT_UNIT);
+  pcnt_counter_pause(TACH_PCNT_UNIT);
+  pcnt_counter_clear(TACH_PCNT_UNIT);
+  pcnt_counter_resume(TACH_PCNT_UNIT);
+  lastTachReadTime = millis();
+}
+
+// Engine RPM from the tach pulses counted over the last TACH_WINDOW_READS
+// reads. A single 100 ms count moves in 200 RPM steps at idle, which is
+// several PSI on the envelope.
+float readEngineRpm() {
+  const GaugeConfig &cfg = config();
+  if (cfg.useSimulatedRpm) {
+    return getSimulatedRpm();
+  }
+
+  int16_t pulses = 0;
+  pcnt_get_counter_value(TACH_PCNT_UNIT, &pulses);
+  pcnt_counter_clear(TACH_PCNT_UNIT);
+
+  unsigned long now = millis();
+  unsigned long elapsed = now - lastTachReadTime;
+  lastTachReadTime = now;
+  if (elapsed == 0 || cfg.tachPulsesPerRev <= 0) return 0.0;
+
+  // Ratio of the window means is total pulses over total time
+  tachPulseWindow.push(pulses);
+  tachTimeWindow.push(elapsed);
+  return tachPulseWindow.mean() * 60000.0f / (tachTimeWindow.mean() * cfg.tachPulsesPerRev);
+}
+
+// Generate simulated RPM matching the simulated pressure profile
+float getSimulatedRpm() {
+  unsigned long runtime = millis() / 1000;
+
+  if (runtime < 5) {
+    return 1200 + random(-20, 20);
+  } else if (runtime < 15) {
+    return 1200 - (runtime - 5) * 40 + random(-20, 20);
+  } else if (runtime < 30) {
+    return 800 + random(-20, 20);
+  } else if (runtime < 35) {
+    float revProgress = (runtime - 30) / 5.0;
+    return 800 + revProgress * 5200 + random(-50, 50);
+  } else if (runtime < 45) {
+    return 5800 + sin(runtime * 0.3) * 200 + random(-50, 50);
+  } else if (runtime < 50) {
+    float revProgress = (runtime - 45) / 5.0;
+    return 5800 - revProgress * 5000 + random(-50, 50);
+  }
+  return 800 + random(-20, 20);
+}
+
+// Compare a sample against the RPM/temperature envelope, with hysteresis
+void checkPressureEnvelope(float pressure, float rpm, float temp) {
+  expectedPressure = envelopeLookup(config().envelope, rpm, temp);
+  bool below = pressure < expectedPressure;
+
+  if (below != pressureDeviation) {
+    if (++deviationCount >= ENV_DEVIATION_SAMPLES) {
+      pressureDeviation = below;
+      deviationCount = 0;
+      if (below) logAlarm(ALARM_LOW_PRESS, (int)pressure);
+      logPrintf("%s%.1f PSI (expected >= %.1f at %d RPM)\n",
+                below ? "Oil pressure LOW for conditions: " : "Oil pressure back in envelope: ",
+                pressure, expectedPressure, (int)rpm);
+    }
+  } else {
+    deviationCount = 0;
+  }
+}
+
+// Oil temperature for the envelope lookup. With real sensors the
+// temperature input is still a placeholder reading 0 C, which would pick the
+// 20 C column and flag a healthy hot idle as low, so the configured fallback
+// is used until a real sender is fitted.
+float envelopeTempC() {
+  const GaugeConfig &cfg = config();
+  return cfg.useSimulatedTemp ? displayTemp : cfg.envFallbackTempC;
+}
+
+void checkTempAlarm(float temp) {
+  float limit = config().tempWarningHigh;
+  if (!tempAlarm && temp > limit) {
+    tempAlarm = true;
+    logAlarm(ALARM_HIGH_TEMP, (int)temp);
+  } else if (tempAlarm && temp < limit - TEMP_ALARM_HYSTERESIS_C) {
+    tempAlarm = false;
+  }
+}
+
+const char *alarmName(uint8_t kind) {
+  switch (kind) {
+    case ALARM_LOW_PRESS: return "LOW PSI";
+    case ALARM_HIGH_TEMP: return "HOT C";
+    case ALARM_SENSOR:    return "SENSOR";
+    default:              return "?";
+  }
+}
+
+void logAlarm(uint8_t kind, int value) {
+  AlarmEvent &a = alarmLog[alarmCount % ALARM_LOG_SIZE];
+  a.timeS = millis() / 1000;
+  a.kind = kind;
+  a.value = value;
+  alarmCount++;
+}
+
 // Generate simulated oil pressure data (2GR-FE realistic values)
 float getSimulatedPressure() {
   unsigned long runtime = millis() / 1000;
@@ -187,76 +669,62 @@ float getSimulatedTemp() {
   return simulatedTemp;
 }
 
-// Create gauge: temperature arc with needle + digital oil pressure readout
-void createGauge() {
-  // --- Meter widget (temperature arc gauge) ---
-  meter = lv_meter_create(lv_scr_act());
-  lv_obj_set_size(meter, 232, 232);
-  lv_obj_align(meter, LV_ALIGN_CENTER, 0, 0);
-  lv_obj_set_style_bg_color(meter, COLOR_BLACK, 0);
-  lv_obj_set_style_bg_opa(meter, LV_OPA_COVER, 0);
-  lv_obj_set_style_border_width(meter, 0, 0);
-  lv_obj_set_style_pad_all(meter, 4, 0);
-  lv_obj_set_style_text_font(meter, &lv_font_montserrat_16, LV_PART_TICKS);
-
-  // Temperature scale: 100-260 deg F (2GR-FE oil temp range), 240 deg arc
-  // LVGL rotation: 0 deg = 3 o'clock, clockwise. 8 o'clock = 150 deg.
-  // 17 ticks (every 10 deg F), major every 4th (every 40 deg F)
-  // Labels: 100, 140, 180, 220, 260
-  lv_meter_scale_t *scale = lv_meter_add_scale(meter);
-  lv_meter_set_scale_ticks(meter, scale, 17, 2, 10, COLOR_WHITE);
-  lv_meter_set_scale_major_ticks(meter, scale, 4, 3, 16, COLOR_WHITE, 18);
-  lv_meter_set_scale_range(meter, scale, 100, 260, 240, 150);
-
-  // Red needle from center to tick edge
-  needle_temp = lv_meter_add_needle_line(meter, scale, 3, COLOR_WARNING, -4);
-  lv_meter_set_indicator_value(meter, needle_temp, 100);
-
-  // Red center pivot dot
-  lv_obj_set_style_size(meter, 12, LV_PART_INDICATOR);
-  lv_obj_set_style_bg_color(meter, COLOR_WARNING, LV_PART_INDICATOR);
-  lv_obj_set_style_bg_opa(meter, LV_OPA_COVER, LV_PART_INDICATOR);
-
-  // "TEMP" label (inside gauge, upper area)
-  label_oil_temp = lv_label_create(lv_scr_act());
-  lv_label_set_text(label_oil_temp, "TEMP");
-  lv_obj_set_style_text_font(label_oil_temp, &lv_font_montserrat_14, 0);
-  lv_obj_set_style_text_color(label_oil_temp, COLOR_WHITE, 0);
-  lv_obj_align(label_oil_temp, LV_ALIGN_CENTER, 0, -35);
-
-  // "PRESSURE" label (below center)
-  label_oil_press = lv_label_create(lv_scr_act());
-  lv_label_set_text(label_oil_press, "PRESSURE");
-  lv_obj_set_style_text_font(label_oil_press, &lv_font_montserrat_12, 0);
-  lv_obj_set_style_text_color(label_oil_press, COLOR_WHITE, 0);
-  lv_obj_align(label_oil_press, LV_ALIGN_CENTER, 0, 36);
-
-  // Pressure value (large digits)
-  label_press_val = lv_label_create(lv_scr_act());
-  lv_label_set_text(label_press_val, "0");
-  lv_obj_set_style_text_font(label_press_val, &lv_font_montserrat_48, 0);
-  lv_obj_set_style_text_color(label_press_val, COLOR_WHITE, 0);
-  lv_obj_align(label_press_val, LV_ALIGN_CENTER, 0, 68);
-
-  // "PSI" unit label
-  label_press_unit = lv_label_create(lv_scr_act());
-  lv_label_set_text(label_press_unit, "PSI");
-  lv_obj_set_style_text_font(label_press_unit, &lv_font_montserrat_14, 0);
-  lv_obj_set_style_text_color(label_press_unit, COLOR_WHITE, 0);
-  lv_obj_align(label_press_unit, LV_ALIGN_CENTER, 0, 100);
-}
-
-// Update gauge indicators
-void updateGauge(float pressure, float temp) {
-  // Convert temperature from C to F and clamp to scale range
-  int tempF = (int)(temp * 9.0 / 5.0 + 32.0);
-  if (tempF < 100) tempF = 100;
-  if (tempF > 260) tempF = 260;
-  lv_meter_set_indicator_value(meter, needle_temp, tempF);
-
-  // Update pressure digital readout
-  lv_label_set_text_fmt(label_press_val, "%d", (int)pressure);
-  lv_obj_align(label_press_val, LV_ALIGN_CENTER, 0, 68);
+int32_t bindingValue(uint8_t binding) {
+  bool havePress = pressureStats.session.samples() > 0;
+  bool haveTemp = tempStats.session.samples() > 0;
+  switch (binding) {
+    case BIND_PSI:          return sensorFault == SENSOR_OK ? (int32_t)displayPressure : VALUE_NONE;
+    case BIND_TEMP_F:       return celsiusToGaugeF(displayTemp);
+    case BIND_RPM:          return (int32_t)currentRpm;
+    case BIND_EXPECTED_PSI: return (int32_t)expectedPressure;
+    case BIND_PSI_MIN:      return havePress ? (int32_t)pressureStats.session.min() : VALUE_NONE;
+    case BIND_PSI_MAX:      return havePress ? (int32_t)pressureStats.session.max() : VALUE_NONE;
+    case BIND_PSI_AVG_10S:  return pressureStats.longWin.samples() ? (int32_t)pressureStats.longWin.mean() : VALUE_NONE;
+    case BIND_TEMP_MIN_F:   return haveTemp ? celsiusToGaugeF(tempStats.session.min()) : VALUE_NONE;
+    case BIND_TEMP_MAX_F:   return haveTemp ? celsiusToGaugeF(tempStats.session.max()) : VALUE_NONE;
+    case BIND_ALARM_COUNT:  return (int32_t)alarmCount;
+    case BIND_SENSOR_FAULT: return sensorFault;
+    default:                return VALUE_NONE;
+  }
+}
+
+bool screenAlarm() {
+  return pressureDeviation || sensorFault != SENSOR_OK;
+}
+
+// Most recent alarm log entries for the alarms screen, newest first
+size_t alarmListText(char *text, size_t size) {
+  if (alarmCount == 0) return 0;
+  size_t len = 0;
+  int lines = alarmCount < ALARM_LIST_LINES ? alarmCount : ALARM_LIST_LINES;
+  for (int i = 0; i < lines; i++) {
+    const AlarmEvent &a = alarmLog[(alarmCount - 1 - i) % ALARM_LOG_SIZE];
+    len += snprintf(text + len, size - len, "%s%u:%02u %s ", i ? "\n" : "",
+                    (unsigned)(a.timeS / 60), (unsigned)(a.timeS % 60), alarmName(a.kind));
+    if (len >= size) break;
+    if (a.kind == ALARM_SENSOR) {
+      len += snprintf(text + len, size - len, "%s", sensorFaultName(a.value));
+    } else {
+      len += snprintf(text + len, size - len, "%d", a.value);
+    }
+    if (len >= size) break;
+  }
+  return len;
+}
+
+void viewLog(const char *line) {
+  logPrintf("%s\n", line);
+}
+
+// Follow cfg.screen; a refused switch is not retried until the setting changes
+void followScreenSetting() {
+  int want = config().screen;
+  if (want == requestedScreen) return;
+  requestedScreen = want;
+  if (!view.show(want)) {
+    logPrintf("Screen %s unavailable, staying on %s\n", SCREENS[want].name,
+              view.active() >= 0 ? SCREENS[view.active()].name : "none");
+  }
 }
 
 // Startup sequence
@@ -264,7 +732,7 @@ void performStartup() {
   lv_obj_t *logo = lv_label_create(lv_scr_act());
   lv_label_set_text(logo, "MR2");
   lv_obj_set_style_text_color(logo, COLOR_WHITE, 0);
-  lv_obj_set_style_text_font(logo, &lv_font_montserrat_48, 0);
+  lv_obj_set_style_text_font(logo, FONT_READOUT, 0);
   lv_obj_center(logo);
 
   for (int i = 0; i < 50; i++) {
@@ -273,48 +741,217 @@ void performStartup() {
   }
 
   lv_obj_del(logo);
-  createGauge();
-  lv_timer_handler();
+  followScreenSetting();
+}
+
+// Gamma-corrected 0-255 brightness -> 12-bit duty, so day/night levels and
+// fade endpoints are perceptually spaced
+void buildGammaTable() {
+  for (int i = 0; i < 256; i++) {
+    blGammaTable[i] = gammaDuty(i, BL_GAMMA, BL_PWM_MAX_DUTY);
+  }
 }
 
-// Update backlight based on headlight state with fade transition
+void initBacklight(int brightness) {
+  buildGammaTable();
+
+  ledc_timer_config_t timerCfg = {};
+  timerCfg.speed_mode = BL_PWM_MODE;
+  timerCfg.duty_resolution = BL_PWM_RESOLUTION;
+  timerCfg.timer_num = BL_PWM_TIMER;
+  timerCfg.freq_hz = BL_PWM_FREQ;
+  timerCfg.clk_cfg = LEDC_AUTO_CLK;
+
+  // APB stops in light sleep, so in that mode run the PWM from the RC fast
+  // clock (kept powered in sleep); if it can't be used, light sleep stays blocked
+  blOnApbClock = true;
+  if (pmActiveMode == PM_MODE_LIGHT_SLEEP) {
+    timerCfg.clk_cfg = LEDC_USE_RTC8M_CLK;
+    timerCfg.freq_hz = BL_PWM_FREQ_SLEEP;
+    if (ledc_timer_config(&timerCfg) == ESP_OK) {
+      esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_ON);
+      blOnApbClock = false;
+    } else {
+      logPrintf("PM: backlight can't run from RC clock, light sleep blocked\n");
+      timerCfg.clk_cfg = LEDC_AUTO_CLK;
+      timerCfg.freq_hz = BL_PWM_FREQ;
+    }
+  }
+  if (blOnApbClock) {
+    ledc_timer_config(&timerCfg);
+  }
+
+  ledc_channel_config_t chCfg = {};
+  chCfg.gpio_num = BL_PIN;
+  chCfg.speed_mode = BL_PWM_MODE;
+  chCfg.channel = BL_PWM_CHANNEL;
+  chCfg.timer_sel = BL_PWM_TIMER;
+  chCfg.duty = blGammaTable[brightness];
+  chCfg.hpoint = 0;
+  ledc_channel_config(&chCfg);
+  ledc_fade_func_install(0);
+
+  ledc_cbs_t cbs = {};
+  cbs.fade_cb = onBacklightFadeEnd;
+  ledc_cb_register(BL_PWM_MODE, BL_PWM_CHANNEL, &cbs, NULL);
+
+  targetBrightness = brightness;
+  blLevel = blFadeFrom = blFadeTo = brightness;
+}
+
+// Request a new brightness; the fade is started by updateBacklight()
+void setBacklightTarget(int brightness) {
+  targetBrightness = brightness;
+}
+
+// The LEDC fade calls take a driver lock, so the interrupt only flags the
+// segment as finished
+bool IRAM_ATTR onBacklightFadeEnd(const ledc_cb_param_t *param, void *arg) {
+  if (param->event == LEDC_FADE_END_EVT) blSegmentRunning = false;
+  return false;
+}
+
+// Start the next segment of the current fade, or plan a new fade from the
+// current level once the target has changed. Segment k ramps to the gamma
+// duty of the level k/BL_FADE_SEGMENTS of the way along, so the fade as a
+// whole follows the perceptual curve rather than a straight line in duty.
+void advanceBacklightFade() {
+  if (blSegmentRunning && (long)(millis() - blSegmentEnd) < BL_FADE_GRACE_MS) return;
+  blSegmentRunning = false;
+
+  if (targetBrightness != blFadeTo) {
+    blFadeFrom = blLevel;
+    blFadeTo = targetBrightness;
+    blFadeSegment = 0;
+  }
+  if (blLevel == blFadeTo) return;
+
+  int fadeMs = config().blFadeDuration;
+  if (fadeMs < BL_FADE_SEGMENTS) {
+    ledc_set_duty(BL_PWM_MODE, BL_PWM_CHANNEL, blGammaTable[blFadeTo]);
+    ledc_update_duty(BL_PWM_MODE, BL_PWM_CHANNEL);
+    blLevel = blFadeTo;
+    return;
+  }
+
+  blFadeSegment++;
+  int level = blFadeFrom + (blFadeTo - blFadeFrom) * blFadeSegment / BL_FADE_SEGMENTS;
+  int segmentMs = fadeMs / BL_FADE_SEGMENTS;
+  if (blGammaTable[level] != blGammaTable[blLevel]) {
+    // Equal duties would give no fade and so no end interrupt
+    blSegmentRunning = true;
+    blSegmentEnd = millis() + segmentMs;
+    ledc_set_fade_with_time(BL_PWM_MODE, BL_PWM_CHANNEL, blGammaTable[level], segmentMs);
+    ledc_fade_start(BL_PWM_MODE, BL_PWM_CHANNEL, LEDC_FADE_NO_WAIT);
+  }
+  blLevel = level;
+}
+
+void IRAM_ATTR onHeadlightEdge() {
+  headlightEdgeTime = millis();
+  headlightEdgePending = true;
+}
+
+// Track headlight state and hand brightness changes to the LEDC fade engine
 void updateBacklight() {
-  bool headlightOn;
+  const GaugeConfig &cfg = config();
+
+  // The physical input is always tracked so the AP trigger works on the
+  // bench with a simulated headlight
+  if (headlightEdgePending && millis() - headlightEdgeTime >= HEADLIGHT_DEBOUNCE_MS) {
+    // Input has been quiet for the debounce period: sample it once
+    headlightEdgePending = false;
+    bool pinOn = digitalRead(HEADLIGHT_PIN) == HIGH;
+    if (pinOn && !headlightPinState) noteHeadlightToggle();
+    if (!pinOn && headlightPinState && millis() < AP_BOOT_WINDOW_MS) apBootOffSeen = true;
+    headlightPinState = pinOn;
+  }
 
-  if (cfg.useSimulatedHeadlight) {
-    headlightOn = ((millis() / 10000) % 2) == 1;
-  } else {
-    headlightOn = digitalRead(HEADLIGHT_PIN) == HIGH;
+  // Edges that arrive while the chip is light-sleeping don't raise the
+  // interrupt, so poll for a missed change in that mode
+  if (pmActiveMode == PM_MODE_LIGHT_SLEEP && !headlightEdgePending &&
+      (digitalRead(HEADLIGHT_PIN) == HIGH) != headlightPinState) {
+    headlightEdgeTime = millis();
+    headlightEdgePending = true;
   }
 
+  bool headlightOn = cfg.useSimulatedHeadlight ? ((millis() / 10000) % 2) == 1 : headlightPinState;
+
   if (headlightOn != lastHeadlightState) {
     lastHeadlightState = headlightOn;
-    fadeStartBrightness = currentBrightness;
-    targetBrightness = headlightOn ? cfg.blBrightnessNight : cfg.blBrightnessDay;
-    fadeStartTime = millis();
-    Serial.print("Headlights ");
-    Serial.println(headlightOn ? "ON - dimming" : "OFF - brightening");
+    setBacklightTarget(headlightOn ? cfg.blBrightnessNight : cfg.blBrightnessDay);
+    logPrintf("Headlights %s\n", headlightOn ? "ON - dimming" : "OFF - brightening");
   }
 
-  if (currentBrightness != targetBrightness) {
-    unsigned long elapsed = millis() - fadeStartTime;
-    if (elapsed >= (unsigned long)cfg.blFadeDuration) {
-      currentBrightness = targetBrightness;
-    } else {
-      float progress = (float)elapsed / cfg.blFadeDuration;
-      currentBrightness = fadeStartBrightness + (int)((targetBrightness - fadeStartBrightness) * progress);
-    }
-    ledcWrite(BL_PWM_CHANNEL, currentBrightness);
+  // Starting a segment while one is running would block on the driver, so
+  // a new target is picked up at the next segment boundary
+  advanceBacklightFade();
+}
+
+// --- Memory Monitor ---
+
+// Sample LVGL pool and system heap usage into the ring, warn on fragmentation
+void sampleMemory() {
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+
+  multi_heap_info_t heap;
+  heap_caps_get_info(&heap, MALLOC_CAP_8BIT);
+
+  MemSample &m = memRing[memRingHead];
+  m.time = millis();
+  m.lvUsed = mon.total_size - mon.free_size;
+  m.lvFree = mon.free_size;
+  m.lvBiggest = mon.free_biggest_size;
+  m.lvFragPct = mon.frag_pct;
+  m.heapFree = heap.total_free_bytes;
+  m.heapBiggest = heap.largest_free_block;
+  m.heapFragPct = heap.total_free_bytes ? 100 - (uint8_t)((uint64_t)heap.largest_free_block * 100 / heap.total_free_bytes) : 0;
+
+  memRingHead = (memRingHead + 1) % MEM_RING_SIZE;
+  if (memRingCount < MEM_RING_SIZE) memRingCount++;
+  lvMaxUsed = mon.max_used;
+  heapMinFree = heap.minimum_free_bytes;
+
+  int fragWarnPct = config().memFragWarnPct;
+  bool warn = m.lvFragPct >= fragWarnPct || m.heapFragPct >= fragWarnPct;
+  if (warn != memFragWarning) {
+    memFragWarning = warn;
+    logPrintf("%s\n", warn ? "WARNING: heap fragmentation above threshold" : "Heap fragmentation back below threshold");
   }
+
+  logPrintf("Mem: LVGL %u used %u free %u big %u%% frag (max %u) | Heap %u free %u big %u%% frag (min %u)\n",
+            (unsigned)m.lvUsed, (unsigned)m.lvFree, (unsigned)m.lvBiggest, m.lvFragPct, (unsigned)lvMaxUsed,
+            (unsigned)m.heapFree, (unsigned)m.heapBiggest, m.heapFragPct, (unsigned)heapMinFree);
 }
 
 // --- NVS Configuration ---
 
+// Atomically publish a complete, validated config and its derived values
+void publishConfig(const GaugeConfig &cfg) {
+  ConfigSnapshot &next = configStore.beginWrite();
+  next.cfg = cfg;
+
+  pressureCoefficients(cfg, ADC_VREF, ADC_MAX_COUNT, &next.psiPerAdcCount, &next.psiOffset);
+
+  SensorLimits &lim = next.sensorLimits;
+  lim.lowRaw = sensorVoltsToAdc(cfg, cfg.sensorMinVoltage - SENSOR_FAULT_MARGIN_V, ADC_VREF, ADC_MAX_COUNT);
+  lim.highRaw = min(sensorVoltsToAdc(cfg, cfg.sensorMaxVoltage + SENSOR_FAULT_MARGIN_V, ADC_VREF, ADC_MAX_COUNT),
+                    (uint16_t)SENSOR_RAIL_HIGH_RAW);
+  lim.probeOpenRaw = (uint16_t)(SENSOR_PROBE_OPEN_V / ADC_VREF * ADC_MAX_COUNT);
+  lim.noiseSpan = SENSOR_NOISE_SPAN_RAW;
+  lim.stuckSpan = SENSOR_STUCK_SPAN;
+
+  configStore.publish();
+}
+
 void loadConfigFromNVS() {
+  GaugeConfig cfg;
   prefs.begin(NVS_NAMESPACE, true);  // read-only
   cfg.useSimulatedData    = prefs.getBool(KEY_SIM_DATA,   DEFAULT_USE_SIMULATED_DATA);
   cfg.useSimulatedTemp    = prefs.getBool(KEY_SIM_TEMP,   DEFAULT_USE_SIMULATED_TEMP);
   cfg.useSimulatedHeadlight = prefs.getBool(KEY_SIM_HL,   DEFAULT_USE_SIMULATED_HEADLIGHT);
+  cfg.useSimulatedRpm     = prefs.getBool(KEY_SIM_RPM,    DEFAULT_USE_SIMULATED_RPM);
   cfg.sensorMinVoltage    = prefs.getFloat(KEY_SENS_MIN_V, DEFAULT_SENSOR_MIN_VOLTAGE);
   cfg.sensorMaxVoltage    = prefs.getFloat(KEY_SENS_MAX_V, DEFAULT_SENSOR_MAX_VOLTAGE);
   cfg.sensorMaxPsi        = prefs.getFloat(KEY_SENS_MAX_P, DEFAULT_SENSOR_MAX_PSI);
@@ -323,19 +960,33 @@ void loadConfigFromNVS() {
   cfg.oilPressureMinSafe  = prefs.getFloat(KEY_OIL_SAFE,  DEFAULT_OIL_PRESSURE_MIN_SAFE);
   cfg.oilPressureMinWarn  = prefs.getFloat(KEY_OIL_WARN,  DEFAULT_OIL_PRESSURE_MIN_WARN);
   cfg.tempWarningHigh     = prefs.getFloat(KEY_TEMP_WARN, DEFAULT_TEMP_WARNING_HIGH);
+  cfg.tachPulsesPerRev    = prefs.getFloat(KEY_TACH_PPR,  DEFAULT_TACH_PULSES_PER_REV);
+  cfg.envFallbackTempC    = prefs.getFloat(KEY_ENV_TEMP,  DEFAULT_ENV_FALLBACK_TEMP_C);
+  if (prefs.getBytesLength(KEY_ENVELOPE) != sizeof(cfg.envelope) ||
+      prefs.getBytes(KEY_ENVELOPE, cfg.envelope, sizeof(cfg.envelope)) != sizeof(cfg.envelope)) {
+    memcpy(cfg.envelope, DEFAULT_ENVELOPE, sizeof(cfg.envelope));
+  }
   cfg.blBrightnessDay     = prefs.getInt(KEY_BL_DAY,      DEFAULT_BL_BRIGHTNESS_DAY);
   cfg.blBrightnessNight   = prefs.getInt(KEY_BL_NIGHT,    DEFAULT_BL_BRIGHTNESS_NIGHT);
   cfg.blFadeDuration      = prefs.getInt(KEY_BL_FADE,     DEFAULT_BL_FADE_DURATION);
   cfg.emaAlpha            = prefs.getFloat(KEY_EMA_ALPHA,  DEFAULT_EMA_ALPHA);
+  cfg.memFragWarnPct      = prefs.getInt(KEY_MEM_FRAG,    DEFAULT_MEM_FRAG_WARN_PCT);
+  cfg.telemetryHz         = prefs.getInt(KEY_TELEM_HZ,    DEFAULT_TELEMETRY_HZ);
+  cfg.apIdleTimeoutS      = prefs.getInt(KEY_AP_IDLE,     DEFAULT_AP_IDLE_TIMEOUT_S);
+  cfg.pmMode              = prefs.getInt(KEY_PM_MODE,     DEFAULT_PM_MODE);
+  cfg.screen              = prefs.getInt(KEY_SCREEN,      DEFAULT_SCREEN);
   prefs.end();
-  Serial.println("Config loaded from NVS");
+  validateConfig(cfg);
+  publishConfig(cfg);
+  logPrintf("Config loaded from NVS\n");
 }
 
-void saveConfigToNVS() {
+void saveConfigToNVS(const GaugeConfig &cfg) {
   prefs.begin(NVS_NAMESPACE, false);  // read-write
   prefs.putBool(KEY_SIM_DATA,   cfg.useSimulatedData);
   prefs.putBool(KEY_SIM_TEMP,   cfg.useSimulatedTemp);
   prefs.putBool(KEY_SIM_HL,     cfg.useSimulatedHeadlight);
+  prefs.putBool(KEY_SIM_RPM,    cfg.useSimulatedRpm);
   prefs.putFloat(KEY_SENS_MIN_V, cfg.sensorMinVoltage);
   prefs.putFloat(KEY_SENS_MAX_V, cfg.sensorMaxVoltage);
   prefs.putFloat(KEY_SENS_MAX_P, cfg.sensorMaxPsi);
@@ -344,12 +995,20 @@ void saveConfigToNVS() {
   prefs.putFloat(KEY_OIL_SAFE,  cfg.oilPressureMinSafe);
   prefs.putFloat(KEY_OIL_WARN,  cfg.oilPressureMinWarn);
   prefs.putFloat(KEY_TEMP_WARN, cfg.tempWarningHigh);
+  prefs.putFloat(KEY_TACH_PPR,  cfg.tachPulsesPerRev);
+  prefs.putFloat(KEY_ENV_TEMP,  cfg.envFallbackTempC);
+  prefs.putBytes(KEY_ENVELOPE,  cfg.envelope, sizeof(cfg.envelope));
   prefs.putInt(KEY_BL_DAY,      cfg.blBrightnessDay);
   prefs.putInt(KEY_BL_NIGHT,    cfg.blBrightnessNight);
   prefs.putInt(KEY_BL_FADE,     cfg.blFadeDuration);
   prefs.putFloat(KEY_EMA_ALPHA,  cfg.emaAlpha);
+  prefs.putInt(KEY_MEM_FRAG,    cfg.memFragWarnPct);
+  prefs.putInt(KEY_TELEM_HZ,    cfg.telemetryHz);
+  prefs.putInt(KEY_AP_IDLE,     cfg.apIdleTimeoutS);
+  prefs.putInt(KEY_PM_MODE,     cfg.pmMode);
+  prefs.putInt(KEY_SCREEN,      cfg.screen);
   prefs.end();
-  Serial.println("Config saved to NVS");
+  logPrintf("Config saved to NVS\n");
 }
 
 void resetConfigToDefaults() {
@@ -357,12 +1016,27 @@ void resetConfigToDefaults() {
   prefs.clear();
   prefs.end();
   loadConfigFromNVS();  // Reloads with compiled defaults
-  Serial.println("Config reset to defaults");
+  logPrintf("Config reset to defaults\n");
 }
 
 // --- WiFi AP & Web Server ---
 
-void initWiFiAP() {
+void registerWebRoutes() {
+  server.on("/", HTTP_GET, handleRoot);
+  server.on("/api/config", HTTP_GET, handleApiConfigGet);
+  server.on("/api/config", HTTP_PATCH, handleApiConfigPatch);
+  server.on("/api/status", HTTP_GET, handleApiStatus);
+  server.on("/reset", HTTP_POST, handleReset);
+  server.on("/stats/reset", HTTP_POST, handleStatsReset);
+  server.on("/mem", HTTP_GET, handleMem);
+  server.on("/sched", HTTP_GET, handleSched);
+  server.on("/render", HTTP_GET, handleRender);
+  server.on("/screens", HTTP_GET, handleScreens);
+  server.on("/update", HTTP_POST, handleUpdateDone, handleUpdateUpload);
+  server.onNotFound(handleNotFound);
+}
+
+void startWiFiAP(const char *reason) {
   WiFi.mode(WIFI_AP);
   IPAddress local_ip(192, 168, 4, 1);
   IPAddress gateway(192, 168, 4, 1);
@@ -370,118 +1044,456 @@ void initWiFiAP() {
   WiFi.softAPConfig(local_ip, gateway, subnet);
 
   if (!WiFi.softAP(WIFI_AP_SSID, WIFI_AP_PASSWORD, WIFI_AP_CHANNEL, 0, WIFI_AP_MAX_CONN)) {
-    Serial.println("WiFi AP failed to start — gauge running without web config");
+    logPrintf("WiFi AP failed to start — gauge running without web config\n");
     WiFi.mode(WIFI_OFF);
     wifiReady = false;
     return;
   }
 
-  server.on("/", HTTP_GET, handleRoot);
-  server.on("/save", HTTP_POST, handleSave);
-  server.on("/reset", HTTP_POST, handleReset);
-  server.onNotFound(handleNotFound);
   server.begin();
   wifiReady = true;
+  apStarts++;
+  apStartedAt = millis();
+  apLastClientTime = apStartedAt;
+
+  logPrintf("WiFi AP started (%s): %s\n", reason, WIFI_AP_SSID);
+  logPrintf("Config URL: http://%s\n", WiFi.softAPIP().toString().c_str());
+}
+
+void stopWiFiAP(const char *reason) {
+  server.stop();
+  WiFi.softAPdisconnect(true);
+  WiFi.mode(WIFI_OFF);
+  wifiReady = false;
+  apTotalMs += millis() - apStartedAt;
+
+  logPrintf("WiFi AP stopped (%s) after %lus\n", reason, (millis() - apStartedAt) / 1000);
+  printLoopLatency();
+  printPowerStats();
+}
 
-  Serial.print("WiFi AP started: ");
-  Serial.println(WIFI_AP_SSID);
-  Serial.print("Config URL: http://");
-  Serial.println(WiFi.softAPIP());
+// Called on each debounced off->on headlight edge
+void noteHeadlightToggle() {
+  unsigned long now = millis();
+  if (apBootOffSeen && now < AP_BOOT_WINDOW_MS) {
+    apBootOffSeen = false;
+    apStartRequest = "boot gesture";
+  }
+
+  apToggleTimes[apToggleHead] = now;
+  apToggleHead = (apToggleHead + 1) % AP_TRIGGER_TOGGLES;
+
+  // The slot at the head is now the oldest of the last AP_TRIGGER_TOGGLES edges
+  unsigned long oldest = apToggleTimes[apToggleHead];
+  if (oldest != 0 && now - oldest <= AP_TRIGGER_WINDOW_MS) {
+    apStartRequest = "headlight toggle";
+    memset(apToggleTimes, 0, sizeof(apToggleTimes));
+  }
 }
 
-String buildConfigPage() {
-  String html = FPSTR(PAGE_HTML);
+// Starts the AP on request and shuts it down once it has had no clients for
+// cfg.apIdleTimeoutS. A repeat trigger while it is up restarts the idle timer.
+void wifiJob() {
+  unsigned long now = millis();
 
-  // Simulation checkboxes
-  html.replace("%SIM_DATA%", cfg.useSimulatedData ? "checked" : "");
-  html.replace("%SIM_TEMP%", cfg.useSimulatedTemp ? "checked" : "");
-  html.replace("%SIM_HL%",   cfg.useSimulatedHeadlight ? "checked" : "");
+  if (apStartRequest) {
+    if (wifiReady) {
+      apLastClientTime = now;
+    } else {
+      startWiFiAP(apStartRequest);
+    }
+    apStartRequest = nullptr;
+  }
+
+  if (!wifiReady) return;
+
+  if (WiFi.softAPgetStationNum() > 0 || otaRebootAt) {
+    apLastClientTime = now;
+  } else if (now - apLastClientTime >= (unsigned long)config().apIdleTimeoutS * 1000UL) {
+    stopWiFiAP("idle");
+  }
+}
 
-  // Sensor calibration
-  html.replace("%SENS_MIN_V%", String(cfg.sensorMinVoltage, 2));
-  html.replace("%SENS_MAX_V%", String(cfg.sensorMaxVoltage, 2));
-  html.replace("%SENS_MAX_P%", String(cfg.sensorMaxPsi, 1));
-  html.replace("%VD_R1%",      String((int)cfg.voltageDividerR1));
-  html.replace("%VD_R2%",      String((int)cfg.voltageDividerR2));
+void printLoopLatency() {
+  logPrintf("Loop latency: radio off mean %uus max %uus (%u), radio on mean %uus max %uus (%u)\n",
+            (unsigned)loopLatency[0].meanUs(), (unsigned)loopLatency[0].maxUs, (unsigned)loopLatency[0].iterations,
+            (unsigned)loopLatency[1].meanUs(), (unsigned)loopLatency[1].maxUs, (unsigned)loopLatency[1].iterations);
+}
 
-  // Safety thresholds
-  html.replace("%OIL_SAFE%",  String(cfg.oilPressureMinSafe, 1));
-  html.replace("%OIL_WARN%",  String(cfg.oilPressureMinWarn, 1));
-  html.replace("%TEMP_WARN%", String(cfg.tempWarningHigh, 1));
+// --- Power Management ---
+
+// Falls back a mode at a time: light sleep needs a core built with tickless
+// idle, DFS needs CONFIG_PM_ENABLE. Without either the CPU stays at full clock.
+void initPowerManagement() {
+  int mode = config().pmMode;
+
+#if CONFIG_PM_ENABLE
+  if (mode != PM_MODE_OFF) {
+    esp_pm_config_esp32s3_t pm = {};
+    pm.max_freq_mhz = PM_MAX_CPU_MHZ;
+    pm.min_freq_mhz = PM_MIN_CPU_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    pm.light_sleep_enable = mode == PM_MODE_LIGHT_SLEEP;
+#else
+    if (mode == PM_MODE_LIGHT_SLEEP) {
+      logPrintf("PM: core built without tickless idle, using DFS only\n");
+      mode = PM_MODE_DFS;
+    }
+#endif
+    if (esp_pm_configure(&pm) != ESP_OK) {
+      logPrintf("PM: configure failed, running at full clock\n");
+      mode = PM_MODE_OFF;
+    }
+  }
+#else
+  if (mode != PM_MODE_OFF) logPrintf("PM: not enabled in this core, running at full clock\n");
+  mode = PM_MODE_OFF;
+#endif
+
+  pmActiveMode = mode;
+  if (mode == PM_MODE_OFF) return;
+
+  esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "flush", &flushLock);
+  esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "adc", &adcLock);
+  if (mode == PM_MODE_LIGHT_SLEEP) {
+    esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "gauge", &sleepLock);
+  }
 
-  // Backlight
-  html.replace("%BL_DAY%",   String(cfg.blBrightnessDay));
-  html.replace("%BL_NIGHT%", String(cfg.blBrightnessNight));
-  html.replace("%BL_FADE%",  String(cfg.blFadeDuration));
+  logPrintf("PM: DFS %d-%d MHz%s\n", PM_MIN_CPU_MHZ, PM_MAX_CPU_MHZ,
+            mode == PM_MODE_LIGHT_SLEEP ? " + light sleep" : "");
+}
 
-  // Display
-  html.replace("%EMA_ALPHA%", String(cfg.emaAlpha, 2));
+// Light sleep pauses PCNT, UART and the APB-clocked PWM, so only allow it
+// while the engine is stopped, the AP is down and telemetry is off
+void updateSleepLock() {
+  if (!sleepLock) return;
+  bool block = currentRpm > 0 || wifiReady || telemetryActiveHz || blOnApbClock;
+  if (block != sleepLockHeld) {
+    if (block) esp_pm_lock_acquire(sleepLock);
+    else esp_pm_lock_release(sleepLock);
+    sleepLockHeld = block;
+  }
+}
 
-  return html;
+void printPowerStats() {
+  logPrintf("Power: mode %d, busy %.1f%%, wake late mean %uus max %uus (%u wakes)\n",
+            pmActiveMode, powerStats.dutyPct(), (unsigned)powerStats.meanWakeLateUs(),
+            (unsigned)powerStats.maxWakeLateUs, (unsigned)powerStats.wakes);
 }
 
 void handleRoot() {
-  server.send(200, "text/html", buildConfigPage());
+  server.send_P(200, "text/html", PAGE_HTML);
 }
 
-void handleSave() {
-  // Simulation toggles (unchecked checkboxes are absent from POST)
-  cfg.useSimulatedData      = server.hasArg("simData");
-  cfg.useSimulatedTemp      = server.hasArg("simTemp");
-  cfg.useSimulatedHeadlight = server.hasArg("simHL");
+// --- JSON API ---
 
-  // Sensor calibration
-  if (server.hasArg("sensMinV")) cfg.sensorMinVoltage = server.arg("sensMinV").toFloat();
-  if (server.hasArg("sensMaxV")) cfg.sensorMaxVoltage = server.arg("sensMaxV").toFloat();
-  if (server.hasArg("sensMaxP")) cfg.sensorMaxPsi     = server.arg("sensMaxP").toFloat();
-  if (server.hasArg("vdR1"))     cfg.voltageDividerR1  = server.arg("vdR1").toFloat();
-  if (server.hasArg("vdR2"))     cfg.voltageDividerR2  = server.arg("vdR2").toFloat();
+template <typename Stats>
+void statsToJson(JsonObject obj, const Stats &st) {
+  obj["n"] = st.samples();
+  obj["min"] = st.min();
+  obj["avg"] = st.mean();
+  obj["max"] = st.max();
+}
 
-  // Safety thresholds
-  if (server.hasArg("oilSafe")) cfg.oilPressureMinSafe = server.arg("oilSafe").toFloat();
-  if (server.hasArg("oilWarn")) cfg.oilPressureMinWarn = server.arg("oilWarn").toFloat();
-  if (server.hasArg("tempWarn")) cfg.tempWarningHigh   = server.arg("tempWarn").toFloat();
+void configToJson(const GaugeConfig &cfg, JsonDocument &doc) {
+  const uint8_t *base = (const uint8_t *)&cfg;
+  for (size_t i = 0; i < CONFIG_FIELD_COUNT; i++) {
+    const ConfigField &f = CONFIG_FIELDS[i];
+    switch (f.type) {
+      case CFG_BOOL:  doc[f.key] = *(const bool *)(base + f.offset); break;
+      case CFG_INT:   doc[f.key] = *(const int *)(base + f.offset); break;
+      case CFG_FLOAT: doc[f.key] = *(const float *)(base + f.offset); break;
+    }
+  }
 
-  // Backlight
-  if (server.hasArg("blDay"))   cfg.blBrightnessDay   = server.arg("blDay").toInt();
-  if (server.hasArg("blNight")) cfg.blBrightnessNight  = server.arg("blNight").toInt();
-  if (server.hasArg("blFade"))  cfg.blFadeDuration     = server.arg("blFade").toInt();
+  JsonArray env = doc[KEY_ENVELOPE].to<JsonArray>();
+  for (int i = 0; i < ENV_RPM_POINTS; i++) {
+    JsonArray row = env.add<JsonArray>();
+    for (int j = 0; j < ENV_TEMP_POINTS; j++) row.add(cfg.envelope[i][j]);
+  }
 
-  // Display
-  if (server.hasArg("emaAlpha")) cfg.emaAlpha = server.arg("emaAlpha").toFloat();
+  // Read-only table axes for the client
+  JsonArray rpmAxis = doc["envRpm"].to<JsonArray>();
+  for (int i = 0; i < ENV_RPM_POINTS; i++) rpmAxis.add(ENV_RPM_AXIS[i]);
+  JsonArray tempAxis = doc["envTemp"].to<JsonArray>();
+  for (int j = 0; j < ENV_TEMP_POINTS; j++) tempAxis.add(ENV_TEMP_AXIS[j]);
+}
+
+void sendConfigJson() {
+  JsonDocument doc;
+  configToJson(config(), doc);
+  String body;
+  serializeJson(doc, body);
+  server.send(200, "application/json", body);
+}
 
-  // Validate and constrain values
-  if (cfg.voltageDividerR2 <= 0) cfg.voltageDividerR2 = DEFAULT_VOLTAGE_DIVIDER_R2;
-  if (cfg.sensorMinVoltage >= cfg.sensorMaxVoltage) {
-    cfg.sensorMinVoltage = DEFAULT_SENSOR_MIN_VOLTAGE;
-    cfg.sensorMaxVoltage = DEFAULT_SENSOR_MAX_VOLTAGE;
+void handleApiConfigGet() {
+  sendConfigJson();
+}
+
+// Apply only the fields present in the body. The candidate is a full copy of
+// the current config, validated and published in one step, so readers never
+// see a mix of old and new values. The NVS write is deferred and coalesced.
+void handleApiConfigPatch() {
+  JsonDocument doc;
+  if (deserializeJson(doc, server.arg("plain")) || !doc.is<JsonObject>()) {
+    server.send(400, "text/plain", "Body must be a JSON object");
+    return;
   }
-  cfg.blBrightnessDay   = constrain(cfg.blBrightnessDay, 0, 255);
-  cfg.blBrightnessNight = constrain(cfg.blBrightnessNight, 0, 255);
-  cfg.blFadeDuration    = constrain(cfg.blFadeDuration, 0, 5000);
-  cfg.emaAlpha          = constrain(cfg.emaAlpha, 0.01f, 1.0f);
 
-  saveConfigToNVS();
+  GaugeConfig cfg = config();
+  uint8_t *base = (uint8_t *)&cfg;
+  for (JsonPair kv : doc.as<JsonObject>()) {
+    const char *key = kv.key().c_str();
+    JsonVariant v = kv.value();
+
+    if (strcmp(key, KEY_ENVELOPE) == 0) {
+      JsonArray rows = v.as<JsonArray>();
+      if (rows.size() != ENV_RPM_POINTS) {
+        server.send(400, "text/plain", "envelope must be " + String(ENV_RPM_POINTS) + " rows");
+        return;
+      }
+      for (int i = 0; i < ENV_RPM_POINTS; i++) {
+        JsonArray row = rows[i].as<JsonArray>();
+        if (row.size() != ENV_TEMP_POINTS) {
+          server.send(400, "text/plain", "envelope rows must have " + String(ENV_TEMP_POINTS) + " values");
+          return;
+        }
+        for (int j = 0; j < ENV_TEMP_POINTS; j++) {
+          // as<float>() would turn a string or null into 0 PSI, silently
+          // disabling the low-pressure check for that cell
+          if (!row[j].is<float>()) {
+            server.send(400, "text/plain", "envelope values must be numbers");
+            return;
+          }
+          cfg.envelope[i][j] = row[j].as<float>();
+        }
+      }
+      continue;
+    }
+
+    const ConfigField *field = NULL;
+    for (size_t i = 0; i < CONFIG_FIELD_COUNT; i++) {
+      if (strcmp(key, CONFIG_FIELDS[i].key) == 0) field = &CONFIG_FIELDS[i];
+    }
+    bool typeOk = field && (field->type == CFG_BOOL ? v.is<bool>() : v.is<float>());
+    if (!typeOk) {
+      server.send(400, "text/plain", String(field ? "Wrong type for " : "Unknown key ") + key);
+      return;
+    }
+    switch (field->type) {
+      case CFG_BOOL:  *(bool *)(base + field->offset) = v.as<bool>(); break;
+      case CFG_INT:   *(int *)(base + field->offset) = v.as<int>(); break;
+      case CFG_FLOAT: *(float *)(base + field->offset) = v.as<float>(); break;
+    }
+  }
+
+  validateConfig(cfg);
+  publishConfig(cfg);
+  configDirty = true;
+  configEditTime = millis();
 
   // Apply backlight immediately
-  targetBrightness = lastHeadlightState ? cfg.blBrightnessNight : cfg.blBrightnessDay;
-  fadeStartBrightness = currentBrightness;
-  fadeStartTime = millis();
+  setBacklightTarget(lastHeadlightState ? cfg.blBrightnessNight : cfg.blBrightnessDay);
+
+  sendConfigJson();
+}
+
+// Live readings, statistics and health in one poll
+void handleApiStatus() {
+  JsonDocument doc;
+  doc["uptime"] = millis() / 1000;
+  doc["psi"] = displayPressure;
+  doc["tempC"] = displayTemp;
+  doc["rpm"] = (int)currentRpm;
+  doc["expectedPsi"] = expectedPressure;
+  doc["lowForConditions"] = pressureDeviation;
+  doc["sensorFault"] = sensorFaultName(sensorFault);
+  doc["sensorAdc"] = pressureBurst.counts();
+  doc["sensorSpan"] = pressureBurst.span();
+
+  JsonObject stats = doc["stats"].to<JsonObject>();
+  statsToJson(stats["psi1s"].to<JsonObject>(), pressureStats.shortWin);
+  statsToJson(stats["psi10s"].to<JsonObject>(), pressureStats.longWin);
+  statsToJson(stats["psiSession"].to<JsonObject>(), pressureStats.session);
+  statsToJson(stats["temp1s"].to<JsonObject>(), tempStats.shortWin);
+  statsToJson(stats["temp10s"].to<JsonObject>(), tempStats.longWin);
+  statsToJson(stats["tempSession"].to<JsonObject>(), tempStats.session);
+
+  if (memRingCount > 0) {
+    const MemSample &m = memRing[(memRingHead + MEM_RING_SIZE - 1) % MEM_RING_SIZE];
+    JsonObject mem = doc["mem"].to<JsonObject>();
+    mem["lvUsed"] = m.lvUsed;
+    mem["lvFrag"] = m.lvFragPct;
+    mem["heapFree"] = m.heapFree;
+    mem["heapFrag"] = m.heapFragPct;
+    mem["fragWarn"] = memFragWarning;
+  }
+  doc["nvsPending"] = configDirty;
+
+  JsonObject telem = doc["telemetry"].to<JsonObject>();
+  telem["hz"] = telemetryActiveHz;
+  telem["dropped"] = telemetryTx.droppedFrames();
+  telem["queued"] = telemetryTx.size();
+
+  JsonObject power = doc["power"].to<JsonObject>();
+  power["mode"] = pmActiveMode;
+  power["busyPct"] = powerStats.dutyPct();
+  power["idleS"] = (uint32_t)(powerStats.idleUs / 1000000);
+  power["wakes"] = powerStats.wakes;
+  power["wakeLateMeanUs"] = powerStats.meanWakeLateUs();
+  power["wakeLateMaxUs"] = powerStats.maxWakeLateUs;
+  JsonArray hist = power["wakeLateHist"].to<JsonArray>();
+  for (int b = 0; b < WAKE_BUCKETS; b++) hist.add(powerStats.wakeHist[b]);
+
+  JsonObject wifi = doc["wifi"].to<JsonObject>();
+  wifi["clients"] = WiFi.softAPgetStationNum();
+  wifi["apUptime"] = (millis() - apStartedAt) / 1000;
+  wifi["apTotal"] = (apTotalMs + millis() - apStartedAt) / 1000;
+  wifi["apStarts"] = apStarts;
+  wifi["idleTimeout"] = config().apIdleTimeoutS;
+  for (int on = 0; on < 2; on++) {
+    JsonObject l = wifi[on ? "loopRadioOn" : "loopRadioOff"].to<JsonObject>();
+    l["n"] = loopLatency[on].iterations;
+    l["meanUs"] = loopLatency[on].meanUs();
+    l["maxUs"] = loopLatency[on].maxUs;
+  }
 
-  server.sendHeader("Location", "/?saved=1");
-  server.send(303);
+  String body;
+  serializeJson(doc, body);
+  server.send(200, "application/json", body);
+}
+
+// Persist API edits once they have settled, so a burst of PATCHes (e.g.
+// dragging emaAlpha) costs one NVS write
+void nvsSaveJob() {
+  if (configDirty && millis() - configEditTime >= NVS_SAVE_DELAY_MS) {
+    configDirty = false;
+    GaugeConfig cfg = config();
+    saveConfigToNVS(cfg);
+  }
 }
 
 void handleReset() {
+  configDirty = false;
   resetConfigToDefaults();
 
   // Apply backlight immediately
-  targetBrightness = lastHeadlightState ? cfg.blBrightnessNight : cfg.blBrightnessDay;
-  fadeStartBrightness = currentBrightness;
-  fadeStartTime = millis();
+  const GaugeConfig &cfg = config();
+  setBacklightTarget(lastHeadlightState ? cfg.blBrightnessNight : cfg.blBrightnessDay);
+
+  sendConfigJson();
+}
+
+void handleStatsReset() {
+  pressureStats.session.reset();
+  tempStats.session.reset();
+  loopLatency[0] = {};
+  loopLatency[1] = {};
+  powerStats = {};
+  logPrintf("Session stats reset\n");
+
+  server.send(204);
+}
+
+// Memory samples, oldest first
+void handleMem() {
+  String json = "{\"lvMaxUsed\":" + String(lvMaxUsed) +
+                ",\"lvTotal\":" + String(LV_MEM_SIZE) +
+                ",\"heapMinFree\":" + String(heapMinFree) +
+                ",\"fragWarn\":" + String(memFragWarning ? "true" : "false") +
+                ",\"samples\":[";
+  for (int i = 0; i < memRingCount; i++) {
+    const MemSample &m = memRing[(memRingHead + MEM_RING_SIZE - memRingCount + i) % MEM_RING_SIZE];
+    if (i) json += ",";
+    json += "{\"t\":" + String(m.time) +
+            ",\"lvUsed\":" + String(m.lvUsed) +
+            ",\"lvFree\":" + String(m.lvFree) +
+            ",\"lvBig\":" + String(m.lvBiggest) +
+            ",\"lvFrag\":" + String(m.lvFragPct) +
+            ",\"heapFree\":" + String(m.heapFree) +
+            ",\"heapBig\":" + String(m.heapBiggest) +
+            ",\"heapFrag\":" + String(m.heapFragPct) + "}";
+  }
+  json += "]}";
+  server.send(200, "application/json", json);
+}
+
+// Per-job timing statistics
+void handleSched() {
+  String json = "[";
+  for (size_t i = 0; i < scheduler.size(); i++) {
+    const SchedJob &j = scheduler.job(i);
+    if (i) json += ",";
+    json += "{\"job\":\"" + String(j.name) + "\"" +
+            ",\"periodUs\":" + String(j.periodUs) +
+            ",\"runs\":" + String(j.stats.runs) +
+            ",\"overruns\":" + String(j.stats.overruns) +
+            ",\"skipped\":" + String(j.stats.skipped) +
+            ",\"jitterMeanUs\":" + String(j.stats.meanJitterUs()) +
+            ",\"jitterMaxUs\":" + String(j.stats.maxJitterUs) +
+            ",\"runMaxUs\":" + String(j.stats.maxRunUs) + "}";
+  }
+  json += "]";
+  server.send(200, "application/json", json);
+}
 
-  server.sendHeader("Location", "/?reset=1");
-  server.send(303);
+// Render time and invalidated area per refresh; ?reset=1 clears the counters
+void handleRender() {
+  String json = "{\"refreshes\":" + String(renderCount) +
+                ",\"lastMs\":" + String(renderLastMs) +
+                ",\"maxMs\":" + String(renderMaxMs) +
+                ",\"meanMs\":" + String(renderCount ? (float)renderSumMs / renderCount : 0.0f, 2) +
+                ",\"lastPx\":" + String(renderLastPx) +
+                ",\"maxPx\":" + String(renderMaxPx) +
+                ",\"meanPx\":" + String(renderCount ? (uint32_t)(renderSumPx / renderCount) : 0) +
+                ",\"screenPx\":" + String(SCREEN_WIDTH * SCREEN_HEIGHT) + "}";
+  if (server.hasArg("reset")) {
+    renderCount = renderLastMs = renderMaxMs = renderLastPx = renderMaxPx = 0;
+    renderSumMs = renderSumPx = 0;
+  }
+  server.send(200, "application/json", json);
+}
+
+// Per-screen build cost and switch timing. ?bench=N cycles through every
+// screen N times (max SCREEN_BENCH_MAX_CYCLES) before reporting, then returns
+// to the configured screen; the gauge does not sample while it runs.
+void handleScreens() {
+  int cycles = server.hasArg("bench") ? clampValue((int)server.arg("bench").toInt(), 1, SCREEN_BENCH_MAX_CYCLES) : 0;
+  if (cycles) {
+    int home = view.active();
+    for (int c = 0; c < cycles; c++) {
+      for (int i = 1; i <= SCREEN_COUNT; i++) {
+        view.show((home + i) % SCREEN_COUNT);
+      }
+    }
+  }
+
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+
+  JsonDocument doc;
+  doc["active"] = view.active() >= 0 ? SCREENS[view.active()].name : "";
+  doc["lvFree"] = mon.free_size;
+  doc["lvFrag"] = mon.frag_pct;
+  JsonArray arr = doc["screens"].to<JsonArray>();
+  for (int i = 0; i < SCREEN_COUNT; i++) {
+    const ScreenState &st = view.state(i);
+    JsonObject o = arr.add<JsonObject>();
+    o["name"] = SCREENS[i].name;
+    o["built"] = st.scr != nullptr;
+    o["memBudget"] = SCREENS[i].memBudget;
+    o["memUsed"] = st.memUsed;
+    o["createUs"] = st.createUs;
+    o["switches"] = st.switches;
+    o["switchLastUs"] = st.lastSwitchUs;
+    o["switchMeanUs"] = st.switches ? (uint32_t)(st.sumSwitchUs / st.switches) : 0;
+    o["switchMaxUs"] = st.maxSwitchUs;
+  }
+
+  String body;
+  serializeJson(doc, body);
+  server.send(200, "application/json", body);
 }
 
 void handleNotFound() {
@@ -490,14 +1502,22 @@ void handleNotFound() {
 }
 
 void setup() {
-  Serial.begin(115200);
+  Serial.begin(115200);  // USB CDC (ARDUINO_USB_CDC_ON_BOOT): the rate is ignored
   delay(100);
 
-  Serial.println("\n\n2GR-FE Dual Gauge (Oil + Temp)");
-  Serial.println("==============================");
+  logPrintf("\n\n2GR-FE Dual Gauge (Oil + Temp)\n");
+  logPrintf("==============================\n");
 
   // Load configuration from NVS (or defaults on first boot)
   loadConfigFromNVS();
+  initPowerManagement();
+
+  esp_ota_img_states_t otaState;
+  if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &otaState) == ESP_OK &&
+      otaState == ESP_OTA_IMG_PENDING_VERIFY) {
+    otaPendingVerify = true;
+    logPrintf("OTA: new firmware pending health check\n");
+  }
 
   pinMode(OIL_PRESSURE_PIN, INPUT);
   analogReadResolution(12);
@@ -513,31 +1533,34 @@ void setup() {
   tft.writedata(0x55);  // RGB565
   tft.fillScreen(TFT_BLACK);
 
+  // Tach input
+  pinMode(TACH_PIN, INPUT);
+  initTachCounter();
+
   // Headlight input
   pinMode(HEADLIGHT_PIN, INPUT_PULLDOWN);
 
+  headlightPinState = digitalRead(HEADLIGHT_PIN) == HIGH;
+
   bool headlightsOnAtBoot;
-  if (cfg.useSimulatedHeadlight) {
+  if (config().useSimulatedHeadlight) {
     headlightsOnAtBoot = ((millis() / 10000) % 2) == 1;
   } else {
-    headlightsOnAtBoot = digitalRead(HEADLIGHT_PIN) == HIGH;
+    headlightsOnAtBoot = headlightPinState;
   }
   lastHeadlightState = headlightsOnAtBoot;
-  int initialBrightness = headlightsOnAtBoot ? cfg.blBrightnessNight : cfg.blBrightnessDay;
-  currentBrightness = initialBrightness;
-  targetBrightness = initialBrightness;
-  fadeStartBrightness = initialBrightness;
+  attachInterrupt(digitalPinToInterrupt(HEADLIGHT_PIN), onHeadlightEdge, CHANGE);
 
-  ledcSetup(BL_PWM_CHANNEL, BL_PWM_FREQ, BL_PWM_RESOLUTION);
-  ledcAttachPin(BL_PIN, BL_PWM_CHANNEL);
-  ledcWrite(BL_PWM_CHANNEL, initialBrightness);
+  initBacklight(headlightsOnAtBoot ? config().blBrightnessNight : config().blBrightnessDay);
 
   lv_init();
+  lv_log_register_print_cb(lvglLog);
   lv_disp_draw_buf_init(&draw_buf, buf1, buf2, SCREEN_WIDTH * 10);
   lv_disp_drv_init(&disp_drv);
   disp_drv.hor_res = SCREEN_WIDTH;
   disp_drv.ver_res = SCREEN_HEIGHT;
   disp_drv.flush_cb = my_disp_flush;
+  disp_drv.monitor_cb = my_disp_monitor;
   disp_drv.draw_buf = &draw_buf;
   lv_disp_drv_register(&disp_drv);
 
@@ -546,52 +1569,239 @@ void setup() {
   // Gauge renders first — WiFi starts after
   performStartup();
 
-  lastUpdateTime = millis();
+  if (config().useSimulatedData) logPrintf("*** SIMULATED OIL PRESSURE ***\n");
+  if (config().useSimulatedTemp) logPrintf("*** SIMULATED TEMPERATURE ***\n");
+  if (config().useSimulatedRpm) logPrintf("*** SIMULATED RPM ***\n");
 
-  if (cfg.useSimulatedData) Serial.println("*** SIMULATED OIL PRESSURE ***");
-  if (cfg.useSimulatedTemp) Serial.println("*** SIMULATED TEMPERATURE ***");
+  // The AP itself only comes up on demand (see wifiJob)
+  registerWebRoutes();
 
-  // Start WiFi AP and web server (non-critical, gauge already visible)
-  initWiFiAP();
+  initScheduler();
 }
 
-void loop() {
-  static unsigned long last_tick = 0;
+// --- OTA Update ---
+
+// Rollback is decided by otaHealthJob() instead of at boot by the core
+bool verifyRollbackLater() {
+  return true;
+}
+
+// Upload callback: WebServer hands us the body in small pieces; OtaStream
+// regroups them into sector-sized flash writes. The whole upload runs inside
+// one handleClient() call, so keep the gauge alive from here.
+void handleUpdateUpload() {
+  HTTPUpload &upload = server.upload();
+  static unsigned long lastRender = 0;
+
+  if (upload.status == UPLOAD_FILE_START) {
+    uint8_t expected[OTA_SHA256_LEN];
+    if (!parseSha256Hex(server.arg("sha256").c_str(), expected)) {
+      ota.reject("missing or malformed sha256");
+      logPrintf("OTA: %s\n", ota.error());
+      return;
+    }
+    logPrintf("OTA: receiving %s\n", upload.filename.c_str());
+    ota.begin(expected);
+  } else if (upload.status == UPLOAD_FILE_WRITE) {
+    ota.write(upload.buf, upload.currentSize);
+  } else if (upload.status == UPLOAD_FILE_END) {
+    ota.end();
+    logPrintf("OTA: %u bytes, %s\n", (unsigned)ota.bytesReceived(),
+              ota.status() == OTA_DONE ? "verified" : ota.error());
+  } else if (upload.status == UPLOAD_FILE_ABORTED) {
+    ota.abort();
+    logPrintf("OTA: upload aborted\n");
+  }
+
+  if (millis() - lastRender >= OTA_RENDER_INTERVAL_MS) {
+    lastRender = millis();
+    acquireJob();
+    filterJob();
+    renderJob();
+  }
+}
+
+void handleUpdateDone() {
+  if (ota.status() != OTA_DONE) {
+    String why = ota.status() == OTA_FAILED ? ota.error() : "no image received";
+    ota.abort();
+    server.send(400, "text/plain", "Update failed: " + why);
+    return;
+  }
+  server.send(200, "text/plain", "Update OK, rebooting");
+  otaRebootAt = millis() + 500;  // let the response go out first
+}
+
+// Jobs whose run counts show the gauge is alive: sampling, filtering and the
+// LVGL handler. LVGL refreshes alone are no measure, since a static screen
+// hardly redraws.
+static const char *const OTA_LIVENESS_JOBS[] = {"acquire", "filter", "render"};
+
+// True if every liveness job has kept up with its releases since the
+// scheduler started
+bool otaLivenessOk() {
+  uint32_t elapsedMs = millis() - schedulerStartMs;
+  for (const char *name : OTA_LIVENESS_JOBS) {
+    const SchedJob *j = scheduler.find(name);
+    if (!j) return false;
+    uint32_t expected = (uint32_t)((uint64_t)elapsedMs * 1000 / j->periodUs);
+    if ((uint64_t)j->stats.runs * 100 < (uint64_t)expected * OTA_HEALTH_MIN_RUN_PCT) {
+      logPrintf("OTA: %s ran %u of %u releases\n", name, (unsigned)j->stats.runs, (unsigned)expected);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Boot health check for a freshly flashed image: keep it once it has run
+// for a while with the sample and render jobs keeping up, otherwise roll
+// back. A crash or watchdog reset before then also rolls back in the
+// bootloader.
+void otaHealthJob() {
+  if (otaRebootAt && (long)(millis() - otaRebootAt) >= 0) {
+    ESP.restart();
+  }
+  if (!otaPendingVerify || millis() < OTA_HEALTH_CHECK_MS) return;
+
+  otaPendingVerify = false;
+  if (otaLivenessOk()) {
+    esp_ota_mark_app_valid_cancel_rollback();
+    logPrintf("OTA: new firmware passed health check\n");
+  } else {
+    logPrintf("OTA: health check failed, rolling back\n");
+    esp_ota_mark_app_invalid_rollback_and_reboot();
+  }
+}
+
+// --- Scheduled Jobs ---
+
+// Period, deadline and priority (0 = highest) per job. Acquire and filter
+// share a release; priority orders filter after acquire.
+void initScheduler() {
+  scheduler.add("acquire",   acquireJob,   SAMPLE_INTERVAL_MS * 1000UL, 20000, 0);
+  scheduler.add("filter",    filterJob,    SAMPLE_INTERVAL_MS * 1000UL, 30000, 1);
+  scheduler.add("render",    renderJob,    RENDER_INTERVAL_MS * 1000UL, 10000, 2);
+  scheduler.add("backlight", backlightJob, BACKLIGHT_INTERVAL_MS * 1000UL, 20000, 3);
+  scheduler.add("network",   networkJob,   NETWORK_INTERVAL_MS * 1000UL, 50000, 4);
+  scheduler.add("log",       logJob,       LOG_INTERVAL_MS * 1000UL, 100000, 5);
+  scheduler.add("memory",    sampleMemory, MEM_SAMPLE_INTERVAL_MS * 1000UL, 100000, 6);
+  scheduler.add("ota",       otaHealthJob, LOG_INTERVAL_MS * 1000UL, 100000, 7);
+  scheduler.add("nvs",       nvsSaveJob,   500 * 1000UL, 100000, 8);
+  scheduler.add("telemetry", telemetryJob, TELEMETRY_IDLE_MS * 1000UL, 1000, 1);
+  scheduler.add("wifi",      wifiJob,      AP_CHECK_INTERVAL_MS * 1000UL, 500000, 9);
+  scheduler.start();
+  schedulerStartMs = millis();
+}
+
+void acquireJob() {
+  currentPressure = readOilPressure();
+  currentTemp = readCoolantTemp();
+  currentRpm = readEngineRpm();
+  updateSleepLock();
+}
+
+void filterJob() {
+  float alpha = config().emaAlpha;
+
+  // A faulted sender's reading is meaningless: keep it out of the stats,
+  // the smoothed value and the envelope check
+  if (sensorFault == SENSOR_OK) {
+    pressureStats.push(currentPressure);
+    displayPressure = emaStep(displayPressure, currentPressure, alpha);
+  }
+  tempStats.push(currentTemp);
+  displayTemp = emaStep(displayTemp, currentTemp, alpha);
+
+  if (sensorFault == SENSOR_OK) {
+    checkPressureEnvelope(currentPressure, currentRpm, envelopeTempC());
+  }
+  checkTempAlarm(displayTemp);
+  followScreenSetting();
+  view.update(false);
+}
+
+void renderJob() {
+  static unsigned long last_tick = millis();
   unsigned long currentTime = millis();
 
   lv_tick_inc(currentTime - last_tick);
   last_tick = currentTime;
 
   lv_timer_handler();
+}
+
+void backlightJob() {
   updateBacklight();
+}
 
+void networkJob() {
   if (wifiReady) {
     server.handleClient();
   }
+}
 
-  if (currentTime - lastUpdateTime >= 100) {
-    lastUpdateTime = currentTime;
+// One binary record per run, queued to the TX ring and drained without
+// blocking. The job period follows cfg.telemetryHz.
+void telemetryJob() {
+  const GaugeConfig &cfg = config();
+  if (cfg.telemetryHz != telemetryActiveHz) {
+    telemetryActiveHz = cfg.telemetryHz;
+    scheduler.setPeriod("telemetry", telemetryActiveHz ? 1000000UL / telemetryActiveHz : TELEMETRY_IDLE_MS * 1000UL);
+  }
 
-    currentPressure = readOilPressure();
-    currentTemp = readCoolantTemp();
+  if (telemetryActiveHz) {
+    TelemetryRecord rec;
+    rec.version = TELEMETRY_VERSION;
+    rec.flags = (cfg.useSimulatedData ? TELEM_FLAG_SIMULATED : 0) | (pressureDeviation ? TELEM_FLAG_LOW_PRESS : 0) |
+                (sensorFault != SENSOR_OK ? TELEM_FLAG_SENSOR_FAULT : 0);
+    rec.seq = telemetrySeq++;
+    rec.timeUs = micros();
+
+    // Fresh single ADC read each record; the 10 Hz path keeps its averaging
+    float psi = currentPressure;
+    rec.adcRaw = 0;
+    if (!cfg.useSimulatedData) {
+      rec.adcRaw = analogRead(OIL_PRESSURE_PIN);
+      const ConfigSnapshot &snap = configStore.read();
+      psi = adcToPsi(rec.adcRaw, snap.psiPerAdcCount, snap.psiOffset, snap.cfg.sensorMaxPsi);
+    }
+    rec.psiX100 = (int16_t)(psi * 100);
+    rec.psiFilteredX100 = (int16_t)(displayPressure * 100);
+    rec.tempCX10 = (int16_t)(displayTemp * 10);
+    rec.rpm = (uint16_t)currentRpm;
 
-    // EMA smoothing
-    float alpha = cfg.emaAlpha;
-    displayPressure = displayPressure * (1 - alpha) + currentPressure * alpha;
-    displayTemp = displayTemp * (1 - alpha) + currentTemp * alpha;
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    telemetryTx.push(frame, telemetryFrame(rec, frame));
+  }
 
-    updateGauge(displayPressure, displayTemp);
-    // Serial logging (1Hz)
-    static unsigned long lastPrint = 0;
-    if (currentTime - lastPrint >= 1000) {
-      lastPrint = currentTime;
-      Serial.print("Oil: ");
-      Serial.print(displayPressure, 1);
-      Serial.print(" PSI | Temp: ");
-      Serial.print(displayTemp, 1);
-      Serial.println(" C");
-    }
+  // Send only what the serial TX buffer can take right now
+  const uint8_t *data;
+  size_t n = telemetryTx.peek(&data);
+  size_t room = Serial.availableForWrite();
+  if (n > room) n = room;
+  if (n > 0) {
+    Serial.write(data, n);
+    telemetryTx.consume(n);
   }
+}
 
-  delay(5);
+// Serial logging (1Hz)
+void logJob() {
+  logPrintf("Oil: %.1f PSI | Temp: %.1f C | %d RPM\n", displayPressure, displayTemp, (int)currentRpm);
+}
+
+void loop() {
+  uint32_t start = micros();
+  uint32_t idleUs = scheduler.runOnce();
+  uint32_t busyUs = micros() - start;
+  loopLatency[wifiReady ? 1 : 0].add(busyUs);
+  powerStats.addBusy(busyUs);
+
+  // Sleep whole milliseconds until the next release; shorter gaps just spin.
+  // With PM on, the idle task drops the clock (or light-sleeps) meanwhile.
+  if (idleUs >= 1000) {
+    uint32_t sleepStart = micros();
+    delay(idleUs / 1000);
+    powerStats.addIdle((idleUs / 1000) * 1000, micros() - sleepStart);
+  }
 }
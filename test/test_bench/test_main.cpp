@@ -0,0 +1,165 @@
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gauge_math.h"
+
+// Nanoseconds per call for the gauge hot paths, checked against the stored
+// baseline (test/bench_baseline.txt, "name ns" per line). A result more than
+// BENCH_TOLERANCE times its baseline (plus BENCH_SLACK_NS for timer noise on
+// sub-ns calls) fails. Baselines are per machine: after an intended change,
+// or on a new machine, rerun with BENCH_UPDATE=1 to rewrite the file.
+
+#define BENCH_ITERATIONS 2000000
+#define BENCH_REPEATS 5         // best of, to drop scheduling noise
+#define BENCH_TOLERANCE 1.5
+#define BENCH_SLACK_NS 1.0
+
+#ifndef BENCH_BASELINE_PATH
+#define BENCH_BASELINE_PATH "test/bench_baseline.txt"
+#endif
+
+void setUp() {}
+void tearDown() {}
+
+static volatile float sinkF;
+static volatile int sinkI;
+
+typedef void (*BenchBody)(int iterations);
+
+static void benchAdcToPsi(int n) {
+    GaugeConfig cfg = defaultGaugeConfig();
+    float perCount, offset;
+    pressureCoefficients(cfg, 3.3f, 4095.0f, &perCount, &offset);
+    float acc = 0;
+    for (int i = 0; i < n; i++) acc += adcToPsi((float)(i & 4095), perCount, offset, cfg.sensorMaxPsi);
+    sinkF = acc;
+}
+
+static void benchPressureCoefficients(int n) {
+    GaugeConfig cfg = defaultGaugeConfig();
+    float acc = 0;
+    for (int i = 0; i < n; i++) {
+        float perCount, offset;
+        cfg.sensorMaxPsi = 100.0f + (i & 7);
+        pressureCoefficients(cfg, 3.3f, 4095.0f, &perCount, &offset);
+        acc += perCount + offset;
+    }
+    sinkF = acc;
+}
+
+static void benchEmaStep(int n) {
+    float v = 0;
+    for (int i = 0; i < n; i++) v = emaStep(v, (float)(i & 63), 0.15f);
+    sinkF = v;
+}
+
+static void benchGammaDuty(int n) {
+    int acc = 0;
+    for (int i = 0; i < n; i++) acc += gammaDuty(i & 255, 2.2f, 4095);
+    sinkI = acc;
+}
+
+static void benchCelsiusToGaugeF(int n) {
+    int acc = 0;
+    for (int i = 0; i < n; i++) acc += celsiusToGaugeF((float)(i & 127));
+    sinkI = acc;
+}
+
+static void benchValidateConfig(int n) {
+    GaugeConfig base = defaultGaugeConfig();
+    int acc = 0;
+    for (int i = 0; i < n; i++) {
+        GaugeConfig cfg = base;
+        cfg.blBrightnessDay = i & 511;
+        cfg.envelope[i & 7][i & 3] = (float)(i & 255);
+        validateConfig(cfg);
+        acc += cfg.blBrightnessDay + (int)cfg.envelope[i & 7][i & 3];
+    }
+    sinkI = acc;
+}
+
+struct BenchCase {
+    const char *name;
+    BenchBody body;
+    int iterations;
+};
+
+static const BenchCase BENCHES[] = {
+    {"adcToPsi",             benchAdcToPsi,             BENCH_ITERATIONS},
+    {"pressureCoefficients", benchPressureCoefficients, BENCH_ITERATIONS},
+    {"emaStep",              benchEmaStep,              BENCH_ITERATIONS},
+    {"gammaDuty",            benchGammaDuty,            BENCH_ITERATIONS},
+    {"celsiusToGaugeF",      benchCelsiusToGaugeF,      BENCH_ITERATIONS},
+    {"validateConfig",       benchValidateConfig,       BENCH_ITERATIONS / 10},
+};
+#define BENCH_COUNT (sizeof(BENCHES) / sizeof(BENCHES[0]))
+
+static double measureNs(const BenchCase &b) {
+    double best = 1e300;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        b.body(b.iterations);
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / b.iterations;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+// Returns the stored ns/call for name, or a negative value if absent
+static double baselineNs(const char *name) {
+    FILE *f = fopen(BENCH_BASELINE_PATH, "r");
+    if (!f) return -1.0;
+    char key[64];
+    double ns;
+    double found = -1.0;
+    while (fscanf(f, "%63s %lf", key, &ns) == 2) {
+        if (strcmp(key, name) == 0) found = ns;
+    }
+    fclose(f);
+    return found;
+}
+
+static bool writeBaseline(const double *results) {
+    FILE *f = fopen(BENCH_BASELINE_PATH, "w");
+    if (!f) return false;
+    for (size_t i = 0; i < BENCH_COUNT; i++) fprintf(f, "%s %.2f\n", BENCHES[i].name, results[i]);
+    fclose(f);
+    return true;
+}
+
+void test_hot_path_benchmarks() {
+    double results[BENCH_COUNT];
+    bool update = getenv("BENCH_UPDATE") != nullptr;
+    bool missing = false;
+    char failures[256] = "";
+
+    printf("%-22s %10s %10s\n", "benchmark", "ns/call", "baseline");
+    for (size_t i = 0; i < BENCH_COUNT; i++) {
+        results[i] = measureNs(BENCHES[i]);
+        double base = baselineNs(BENCHES[i].name);
+        printf("%-22s %10.2f %10.2f\n", BENCHES[i].name, results[i], base);
+
+        if (base < 0) {
+            missing = true;
+        } else if (results[i] > base * BENCH_TOLERANCE + BENCH_SLACK_NS) {
+            size_t len = strlen(failures);
+            snprintf(failures + len, sizeof(failures) - len, "%s%s %.2f ns (baseline %.2f)",
+                     len ? ", " : "", BENCHES[i].name, results[i], base);
+        }
+    }
+
+    if (update || missing) {
+        TEST_ASSERT_TRUE_MESSAGE(writeBaseline(results), "cannot write " BENCH_BASELINE_PATH);
+        TEST_IGNORE_MESSAGE("baseline written to " BENCH_BASELINE_PATH);
+    }
+    if (failures[0]) TEST_FAIL_MESSAGE(failures);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_hot_path_benchmarks);
+    return UNITY_END();
+}
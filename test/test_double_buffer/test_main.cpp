@@ -0,0 +1,91 @@
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "double_buffer.h"
+
+// Snapshots must never mix two publishes, including for a reader that runs
+// on another thread while the writer publishes back to back.
+
+#define PAYLOAD_WORDS 64
+#define STRESS_PUBLISHES 200000
+
+struct Payload {
+    uint32_t words[PAYLOAD_WORDS];
+};
+
+void setUp() {}
+void tearDown() {}
+
+static void fill(Payload &p, uint32_t v) {
+    for (int i = 0; i < PAYLOAD_WORDS; i++) p.words[i] = v;
+}
+
+static bool consistent(const Payload &p) {
+    for (int i = 1; i < PAYLOAD_WORDS; i++) {
+        if (p.words[i] != p.words[0]) return false;
+    }
+    return true;
+}
+
+void test_read_returns_published_value() {
+    DoubleBuffer<Payload> buf;
+    TEST_ASSERT_EQUAL_UINT32(0, buf.read().words[0]);
+
+    fill(buf.beginWrite(), 7);
+    TEST_ASSERT_EQUAL_UINT32(0, buf.read().words[0]);  // not visible until published
+    buf.publish();
+    TEST_ASSERT_EQUAL_UINT32(7, buf.read().words[5]);
+}
+
+void test_begin_write_starts_from_active() {
+    DoubleBuffer<Payload> buf;
+    fill(buf.beginWrite(), 3);
+    buf.publish();
+
+    Payload &next = buf.beginWrite();
+    TEST_ASSERT_TRUE(consistent(next));
+    TEST_ASSERT_EQUAL_UINT32(3, next.words[0]);
+    next.words[0] = 4;
+    buf.publish();
+    TEST_ASSERT_EQUAL_UINT32(4, buf.read().words[0]);
+    TEST_ASSERT_EQUAL_UINT32(3, buf.read().words[1]);
+}
+
+void test_concurrent_reader_never_sees_torn_snapshot() {
+    DoubleBuffer<Payload> buf;
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> torn{0};
+    std::atomic<uint32_t> backwards{0};
+    std::atomic<uint32_t> reads{0};
+
+    std::thread reader([&] {
+        uint32_t last = 0;
+        while (!done.load()) {
+            Payload p = buf.read();
+            if (!consistent(p)) torn++;
+            if (p.words[0] < last) backwards++;
+            last = p.words[0];
+            reads++;
+        }
+    });
+
+    for (uint32_t n = 1; n <= STRESS_PUBLISHES; n++) {
+        fill(buf.beginWrite(), n);
+        buf.publish();
+    }
+    done = true;
+    reader.join();
+
+    TEST_ASSERT_TRUE(reads.load() > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+    TEST_ASSERT_EQUAL_UINT32(STRESS_PUBLISHES, buf.read().words[0]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_read_returns_published_value);
+    RUN_TEST(test_begin_write_starts_from_active);
+    RUN_TEST(test_concurrent_reader_never_sees_torn_snapshot);
+    return UNITY_END();
+}
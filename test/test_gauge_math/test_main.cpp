@@ -0,0 +1,257 @@
+#include <unity.h>
+#include "gauge_math.h"
+
+// Hot-path math from gauge_math.h against the formulas it replaced in
+// main.cpp, the expected-pressure envelope lookup, plus the config clamping
+// applied before every publish.
+
+#define ADC_VREF 3.3f
+#define ADC_MAX_COUNT 4095.0f
+
+void setUp() {}
+void tearDown() {}
+
+// readOilPressure() before the coefficients were folded together
+static float originalPsi(const GaugeConfig &cfg, float adcValue) {
+    float measuredVoltage = adcValue * 3.3 / 4095.0;
+    float sensorVoltage = measuredVoltage * (cfg.voltageDividerR1 + cfg.voltageDividerR2) / cfg.voltageDividerR2;
+    float pressure = (sensorVoltage - cfg.sensorMinVoltage) / (cfg.sensorMaxVoltage - cfg.sensorMinVoltage) * cfg.sensorMaxPsi;
+    if (pressure < 0) pressure = 0;
+    if (pressure > cfg.sensorMaxPsi) pressure = cfg.sensorMaxPsi;
+    return pressure;
+}
+
+static void checkAgainstOriginal(const GaugeConfig &cfg) {
+    float perCount, offset;
+    pressureCoefficients(cfg, ADC_VREF, ADC_MAX_COUNT, &perCount, &offset);
+    for (int adc = 0; adc <= 4095; adc++) {
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, originalPsi(cfg, adc), adcToPsi(adc, perCount, offset, cfg.sensorMaxPsi));
+    }
+    // Fractional counts from the oversampled burst
+    for (float adc = 0.0f; adc <= 4095.0f; adc += 17.25f) {
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, originalPsi(cfg, adc), adcToPsi(adc, perCount, offset, cfg.sensorMaxPsi));
+    }
+}
+
+void test_pressure_matches_original_formula() {
+    checkAgainstOriginal(defaultGaugeConfig());
+}
+
+void test_pressure_matches_original_formula_other_calibration() {
+    GaugeConfig cfg = defaultGaugeConfig();
+    cfg.sensorMinVoltage = 0.3f;
+    cfg.sensorMaxVoltage = 4.8f;
+    cfg.sensorMaxPsi = 150.0f;
+    cfg.voltageDividerR1 = 4700.0f;
+    cfg.voltageDividerR2 = 6800.0f;
+    checkAgainstOriginal(cfg);
+}
+
+void test_pressure_clamps_to_sensor_range() {
+    GaugeConfig cfg = defaultGaugeConfig();
+    float perCount, offset;
+    pressureCoefficients(cfg, ADC_VREF, ADC_MAX_COUNT, &perCount, &offset);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, adcToPsi(0, perCount, offset, cfg.sensorMaxPsi));
+    TEST_ASSERT_EQUAL_FLOAT(cfg.sensorMaxPsi, adcToPsi(4095, perCount, offset, cfg.sensorMaxPsi));
+}
+
+void test_sensor_volts_to_adc() {
+    GaugeConfig cfg = defaultGaugeConfig();
+    // 4.5 V through 3.9k/10k is 3.237 V at the pin
+    TEST_ASSERT_EQUAL_UINT16(4017, sensorVoltsToAdc(cfg, 4.5f, ADC_VREF, ADC_MAX_COUNT));
+    TEST_ASSERT_EQUAL_UINT16(0, sensorVoltsToAdc(cfg, -1.0f, ADC_VREF, ADC_MAX_COUNT));
+    TEST_ASSERT_EQUAL_UINT16(4095, sensorVoltsToAdc(cfg, 12.0f, ADC_VREF, ADC_MAX_COUNT));
+}
+
+void test_ema_step() {
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, emaStep(10.0f, 10.0f, 0.15f));
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, emaStep(0.0f, 100.0f, 0.15f));
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, emaStep(0.0f, 100.0f, 1.0f));
+
+    // Step response: after n samples the remaining error is (1 - alpha)^n
+    float v = 0.0f;
+    for (int i = 0; i < 20; i++) v = emaStep(v, 50.0f, 0.15f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f * (1.0f - powf(0.85f, 20)), v);
+}
+
+void test_gamma_duty_endpoints() {
+    TEST_ASSERT_EQUAL_UINT16(0, gammaDuty(0, 2.2f, 4095));
+    TEST_ASSERT_EQUAL_UINT16(4095, gammaDuty(255, 2.2f, 4095));
+    TEST_ASSERT_EQUAL_UINT16(0, gammaDuty(-10, 2.2f, 4095));
+    TEST_ASSERT_EQUAL_UINT16(4095, gammaDuty(300, 2.2f, 4095));
+}
+
+void test_gamma_duty_curve() {
+    // Half brightness is about a fifth of full duty at gamma 2.2
+    TEST_ASSERT_UINT16_WITHIN(2, 898, gammaDuty(128, 2.2f, 4095));
+    // Gamma 1 is linear
+    TEST_ASSERT_UINT16_WITHIN(1, 2056, gammaDuty(128, 1.0f, 4095));
+
+    uint16_t prev = 0;
+    for (int i = 1; i < 256; i++) {
+        uint16_t d = gammaDuty(i, 2.2f, 4095);
+        TEST_ASSERT_TRUE(d >= prev);
+        prev = d;
+    }
+}
+
+void test_celsius_to_gauge_f() {
+    TEST_ASSERT_EQUAL_INT(212, celsiusToGaugeF(100.0f));
+    TEST_ASSERT_EQUAL_INT(194, celsiusToGaugeF(90.0f));
+    TEST_ASSERT_EQUAL_INT(GAUGE_TEMP_MIN_F, celsiusToGaugeF(0.0f));
+    TEST_ASSERT_EQUAL_INT(GAUGE_TEMP_MAX_F, celsiusToGaugeF(150.0f));
+}
+
+void test_validate_keeps_defaults() {
+    GaugeConfig cfg = defaultGaugeConfig();
+    GaugeConfig orig = cfg;
+    validateConfig(cfg);
+    TEST_ASSERT_EQUAL_MEMORY(&orig, &cfg, sizeof(cfg));
+}
+
+void test_validate_clamps_ranges() {
+    GaugeConfig cfg = defaultGaugeConfig();
+    cfg.blBrightnessDay = 300;
+    cfg.blBrightnessNight = -5;
+    cfg.blFadeDuration = 60000;
+    cfg.emaAlpha = 0.0f;
+    cfg.screen = 99;
+    cfg.memFragWarnPct = 0;
+    cfg.apIdleTimeoutS = 5;
+    cfg.pmMode = 7;
+    cfg.envFallbackTempC = 150.0f;
+    validateConfig(cfg);
+    TEST_ASSERT_EQUAL_INT(255, cfg.blBrightnessDay);
+    TEST_ASSERT_EQUAL_INT(0, cfg.blBrightnessNight);
+    TEST_ASSERT_EQUAL_INT(5000, cfg.blFadeDuration);
+    TEST_ASSERT_EQUAL_FLOAT(0.01f, cfg.emaAlpha);
+    TEST_ASSERT_EQUAL_INT(SCREEN_COUNT - 1, cfg.screen);
+    TEST_ASSERT_EQUAL_INT(1, cfg.memFragWarnPct);
+    TEST_ASSERT_EQUAL_INT(30, cfg.apIdleTimeoutS);
+    TEST_ASSERT_EQUAL_INT(PM_MODE_LIGHT_SLEEP, cfg.pmMode);
+    TEST_ASSERT_EQUAL_FLOAT(120.0f, cfg.envFallbackTempC);
+}
+
+void test_validate_telemetry_rate() {
+    GaugeConfig cfg = defaultGaugeConfig();
+    int in[]  = {-5, 0, 50, 100, 500, 5000};
+    int out[] = {0,  0, 100, 100, 500, 1000};
+    for (int i = 0; i < 6; i++) {
+        cfg.telemetryHz = in[i];
+        validateConfig(cfg);
+        TEST_ASSERT_EQUAL_INT(out[i], cfg.telemetryHz);
+    }
+}
+
+void test_validate_resets_bad_calibration() {
+    GaugeConfig cfg = defaultGaugeConfig();
+    cfg.voltageDividerR2 = 0.0f;
+    cfg.sensorMinVoltage = 4.5f;
+    cfg.sensorMaxVoltage = 0.5f;
+    cfg.tachPulsesPerRev = -1.0f;
+    validateConfig(cfg);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_VOLTAGE_DIVIDER_R2, cfg.voltageDividerR2);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_SENSOR_MIN_VOLTAGE, cfg.sensorMinVoltage);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_SENSOR_MAX_VOLTAGE, cfg.sensorMaxVoltage);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_TACH_PULSES_PER_REV, cfg.tachPulsesPerRev);
+}
+
+void test_validate_sensor_max_psi() {
+    GaugeConfig cfg = defaultGaugeConfig();
+    float in[]  = {0.0f, -50.0f, 5.0f, 150.0f, 300.0f, 400.0f, 1e6f};
+    float out[] = {DEFAULT_SENSOR_MAX_PSI, DEFAULT_SENSOR_MAX_PSI, 10.0f, 150.0f, 300.0f, 300.0f, 300.0f};
+    for (int i = 0; i < 7; i++) {
+        cfg.sensorMaxPsi = in[i];
+        validateConfig(cfg);
+        TEST_ASSERT_EQUAL_FLOAT(out[i], cfg.sensorMaxPsi);
+        // Full scale must fit the int16 PSI x100 telemetry field
+        TEST_ASSERT_TRUE(cfg.sensorMaxPsi * 100.0f <= 32767.0f);
+    }
+
+    // The envelope is clamped against the corrected value, not the bad one
+    cfg.sensorMaxPsi = -1.0f;
+    cfg.envelope[6][0] = 250.0f;
+    validateConfig(cfg);
+    TEST_ASSERT_EQUAL_FLOAT(DEFAULT_SENSOR_MAX_PSI, cfg.envelope[6][0]);
+}
+
+void test_validate_clamps_envelope() {
+    GaugeConfig cfg = defaultGaugeConfig();
+    cfg.envelope[1][0] = -3.0f;
+    cfg.envelope[6][3] = 500.0f;
+    validateConfig(cfg);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, cfg.envelope[1][0]);
+    TEST_ASSERT_EQUAL_FLOAT(cfg.sensorMaxPsi, cfg.envelope[6][3]);
+}
+
+void test_envelope_at_grid_points() {
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, envelopeLookup(DEFAULT_ENVELOPE, 0.0f, 20.0f));
+    TEST_ASSERT_EQUAL_FLOAT(11.0f, envelopeLookup(DEFAULT_ENVELOPE, 1000.0f, 60.0f));
+    TEST_ASSERT_EQUAL_FLOAT(24.0f, envelopeLookup(DEFAULT_ENVELOPE, 3000.0f, 90.0f));
+    TEST_ASSERT_EQUAL_FLOAT(37.0f, envelopeLookup(DEFAULT_ENVELOPE, 6000.0f, 120.0f));
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, envelopeLookup(DEFAULT_ENVELOPE, 7000.0f, 20.0f));
+}
+
+void test_envelope_at_cell_midpoints() {
+    // Mean of the four corners: 11, 8, 20, 16
+    TEST_ASSERT_EQUAL_FLOAT(13.75f, envelopeLookup(DEFAULT_ENVELOPE, 1500.0f, 75.0f));
+    // 24, 20, 32, 27
+    TEST_ASSERT_EQUAL_FLOAT(25.75f, envelopeLookup(DEFAULT_ENVELOPE, 3500.0f, 105.0f));
+    // On a temperature grid line: midway between 16 and 24
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, envelopeLookup(DEFAULT_ENVELOPE, 2500.0f, 90.0f));
+    // On an RPM grid line: midway between 38 and 32
+    TEST_ASSERT_EQUAL_FLOAT(35.0f, envelopeLookup(DEFAULT_ENVELOPE, 5000.0f, 105.0f));
+}
+
+void test_envelope_clamps_out_of_range() {
+    TEST_ASSERT_EQUAL_FLOAT(39.0f, envelopeLookup(DEFAULT_ENVELOPE, 9000.0f, 150.0f));
+    TEST_ASSERT_EQUAL_FLOAT(60.0f, envelopeLookup(DEFAULT_ENVELOPE, 9000.0f, -10.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, envelopeLookup(DEFAULT_ENVELOPE, -100.0f, 60.0f));
+    TEST_ASSERT_EQUAL_FLOAT(16.0f, envelopeLookup(DEFAULT_ENVELOPE, 1000.0f, -10.0f));
+    TEST_ASSERT_EQUAL_FLOAT(6.0f, envelopeLookup(DEFAULT_ENVELOPE, 1000.0f, 150.0f));
+    // Clamped on one axis, interpolated on the other: midway between 51 and 46
+    TEST_ASSERT_EQUAL_FLOAT(48.5f, envelopeLookup(DEFAULT_ENVELOPE, 9000.0f, 75.0f));
+    TEST_ASSERT_EQUAL_FLOAT(13.0f, envelopeLookup(DEFAULT_ENVELOPE, 2000.0f, 120.5f));
+}
+
+// Bilinear in rpm and temperature, so the lookup is exact anywhere in range
+static float bilinearSurface(float rpm, float tempC) {
+    return 2.0f + rpm * 0.01f - tempC * 0.1f + rpm * tempC * 1e-4f;
+}
+
+void test_envelope_exact_on_bilinear_table() {
+    float table[ENV_RPM_POINTS][ENV_TEMP_POINTS];
+    for (int i = 0; i < ENV_RPM_POINTS; i++) {
+        for (int j = 0; j < ENV_TEMP_POINTS; j++) {
+            table[i][j] = bilinearSurface(ENV_RPM_AXIS[i], ENV_TEMP_AXIS[j]);
+        }
+    }
+    for (float rpm = 0.0f; rpm <= 7000.0f; rpm += 350.0f) {
+        for (float t = 20.0f; t <= 120.0f; t += 7.5f) {
+            TEST_ASSERT_FLOAT_WITHIN(1e-3f, bilinearSurface(rpm, t), envelopeLookup(table, rpm, t));
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_pressure_matches_original_formula);
+    RUN_TEST(test_pressure_matches_original_formula_other_calibration);
+    RUN_TEST(test_pressure_clamps_to_sensor_range);
+    RUN_TEST(test_sensor_volts_to_adc);
+    RUN_TEST(test_ema_step);
+    RUN_TEST(test_gamma_duty_endpoints);
+    RUN_TEST(test_gamma_duty_curve);
+    RUN_TEST(test_celsius_to_gauge_f);
+    RUN_TEST(test_validate_keeps_defaults);
+    RUN_TEST(test_validate_clamps_ranges);
+    RUN_TEST(test_validate_telemetry_rate);
+    RUN_TEST(test_validate_resets_bad_calibration);
+    RUN_TEST(test_validate_sensor_max_psi);
+    RUN_TEST(test_validate_clamps_envelope);
+    RUN_TEST(test_envelope_at_grid_points);
+    RUN_TEST(test_envelope_at_cell_midpoints);
+    RUN_TEST(test_envelope_clamps_out_of_range);
+    RUN_TEST(test_envelope_exact_on_bilinear_table);
+    return UNITY_END();
+}
@@ -0,0 +1,327 @@
+#include <unity.h>
+#include "ota_stream.h"
+
+// OtaStream against a fake partition and hasher: chunk regrouping, digest
+// check, and that every failure path aborts the backend exactly once.
+
+#define TEST_CHUNK 16
+#define IMAGE_MAX 512
+#define WRITES_MAX 64
+
+class FakeBackend : public OtaBackend {
+public:
+    bool begin() override {
+        begins++;
+        len = 0;
+        writeCount = 0;
+        return !failBegin;
+    }
+    bool write(const uint8_t *data, size_t n) override {
+        if (failWriteAt >= 0 && writeCount == failWriteAt) return false;
+        if (writeCount < WRITES_MAX) writeSizes[writeCount] = n;
+        writeCount++;
+        memcpy(image + len, data, n);
+        len += n;
+        return true;
+    }
+    bool commit() override {
+        commits++;
+        return !failCommit;
+    }
+    void abort() override { aborts++; }
+
+    uint8_t image[IMAGE_MAX];
+    size_t len = 0;
+    size_t writeSizes[WRITES_MAX];
+    int writeCount = 0;
+    int begins = 0;
+    int commits = 0;
+    int aborts = 0;
+    bool failBegin = false;
+    bool failCommit = false;
+    int failWriteAt = -1;
+};
+
+// Not SHA-256: folds the bytes and length into 32 bytes, which is enough to
+// tell images apart and to check the hasher sees exactly what is flashed
+class FakeHasher : public OtaHasher {
+public:
+    void begin() override {
+        memset(state, 0, sizeof(state));
+        total = 0;
+    }
+    void update(const uint8_t *data, size_t n) override {
+        for (size_t i = 0; i < n; i++, total++) {
+            state[total % OTA_SHA256_LEN] = (uint8_t)(state[total % OTA_SHA256_LEN] * 31 + data[i] + 1);
+        }
+    }
+    void finish(uint8_t out[OTA_SHA256_LEN]) override {
+        memcpy(out, state, OTA_SHA256_LEN);
+        out[0] ^= (uint8_t)total;
+        out[1] ^= (uint8_t)(total >> 8);
+    }
+
+    uint8_t state[OTA_SHA256_LEN];
+    size_t total = 0;
+};
+
+static FakeBackend backend;
+static FakeHasher hasher;
+static uint8_t image[IMAGE_MAX];
+
+static void digestOf(const uint8_t *data, size_t len, uint8_t out[OTA_SHA256_LEN]) {
+    FakeHasher h;
+    h.begin();
+    h.update(data, len);
+    h.finish(out);
+}
+
+void setUp() {
+    backend = FakeBackend();
+    hasher = FakeHasher();
+    for (int i = 0; i < IMAGE_MAX; i++) image[i] = (uint8_t)(i * 7 + 3);
+}
+void tearDown() {}
+
+void test_regroups_odd_pieces_into_chunks() {
+    const size_t len = 100;
+    const size_t pieces[] = {1, 3, 7, 5, 13, 16, 2, 31, 22};  // sums to 100
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, len, digest);
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    TEST_ASSERT_TRUE(ota.begin(digest));
+    size_t off = 0;
+    for (size_t p : pieces) {
+        TEST_ASSERT_TRUE(ota.write(image + off, p));
+        off += p;
+    }
+    TEST_ASSERT_EQUAL_UINT32(len, off);
+    TEST_ASSERT_TRUE(ota.end());
+
+    TEST_ASSERT_EQUAL(OTA_DONE, ota.status());
+    TEST_ASSERT_EQUAL_UINT32(len, ota.bytesReceived());
+    TEST_ASSERT_EQUAL_INT(7, backend.writeCount);
+    for (int i = 0; i < 6; i++) TEST_ASSERT_EQUAL_UINT32(TEST_CHUNK, backend.writeSizes[i]);
+    TEST_ASSERT_EQUAL_UINT32(4, backend.writeSizes[6]);
+    TEST_ASSERT_EQUAL_UINT32(len, backend.len);
+    TEST_ASSERT_EQUAL_MEMORY(image, backend.image, len);
+    TEST_ASSERT_EQUAL_INT(1, backend.commits);
+    TEST_ASSERT_EQUAL_INT(0, backend.aborts);
+}
+
+void test_piece_spanning_several_chunks() {
+    const size_t len = 3 * TEST_CHUNK + 5;
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, len, digest);
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(digest);
+    TEST_ASSERT_TRUE(ota.write(image, 9));
+    TEST_ASSERT_TRUE(ota.write(image + 9, len - 9));
+    TEST_ASSERT_EQUAL_INT(3, backend.writeCount);  // tail still buffered
+    TEST_ASSERT_TRUE(ota.end());
+    TEST_ASSERT_EQUAL_INT(4, backend.writeCount);
+    TEST_ASSERT_EQUAL_MEMORY(image, backend.image, len);
+}
+
+void test_exact_chunk_multiple_has_no_tail_write() {
+    const size_t len = 2 * TEST_CHUNK;
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, len, digest);
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(digest);
+    ota.write(image, len);
+    TEST_ASSERT_TRUE(ota.end());
+    TEST_ASSERT_EQUAL_INT(2, backend.writeCount);
+}
+
+void test_sha_mismatch_aborts() {
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, 64, digest);
+    digest[5] ^= 1;
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(digest);
+    ota.write(image, 64);
+    TEST_ASSERT_FALSE(ota.end());
+
+    TEST_ASSERT_EQUAL(OTA_FAILED, ota.status());
+    TEST_ASSERT_EQUAL_STRING("SHA-256 mismatch", ota.error());
+    TEST_ASSERT_EQUAL_INT(0, backend.commits);
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+
+    // A later abort from the web handler must not abort the backend again
+    ota.abort();
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+}
+
+void test_flash_write_failure_aborts() {
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, 100, digest);
+    backend.failWriteAt = 2;
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(digest);
+    TEST_ASSERT_TRUE(ota.write(image, 40));      // two chunks written, 8 bytes buffered
+    TEST_ASSERT_FALSE(ota.write(image + 40, 20)); // third chunk fails
+    TEST_ASSERT_EQUAL(OTA_FAILED, ota.status());
+    TEST_ASSERT_EQUAL_STRING("flash write failed", ota.error());
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+
+    // The rest of the upload is ignored and end() does not commit
+    TEST_ASSERT_FALSE(ota.write(image + 60, 40));
+    TEST_ASSERT_FALSE(ota.end());
+    TEST_ASSERT_EQUAL_INT(0, backend.commits);
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+}
+
+void test_commit_failure_aborts() {
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, 20, digest);
+    backend.failCommit = true;
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(digest);
+    ota.write(image, 20);
+    TEST_ASSERT_FALSE(ota.end());
+    TEST_ASSERT_EQUAL_STRING("image rejected", ota.error());
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+}
+
+void test_empty_image_fails() {
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, 0, digest);
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(digest);
+    TEST_ASSERT_FALSE(ota.end());
+    TEST_ASSERT_EQUAL(OTA_FAILED, ota.status());
+    TEST_ASSERT_EQUAL_STRING("empty image", ota.error());
+    TEST_ASSERT_EQUAL_INT(0, backend.writeCount);
+    TEST_ASSERT_EQUAL_INT(0, backend.commits);
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+}
+
+void test_rebegin_while_receiving_restarts() {
+    uint8_t first[OTA_SHA256_LEN], second[OTA_SHA256_LEN];
+    digestOf(image, 50, first);
+    digestOf(image + 100, 30, second);
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(first);
+    ota.write(image, 25);
+    TEST_ASSERT_TRUE(ota.begin(second));
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+    TEST_ASSERT_EQUAL_INT(2, backend.begins);
+    TEST_ASSERT_EQUAL_UINT32(0, ota.bytesReceived());
+
+    // Nothing buffered from the first upload leaks into the second
+    ota.write(image + 100, 30);
+    TEST_ASSERT_TRUE(ota.end());
+    TEST_ASSERT_EQUAL_UINT32(30, backend.len);
+    TEST_ASSERT_EQUAL_MEMORY(image + 100, backend.image, 30);
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+    TEST_ASSERT_EQUAL_INT(1, backend.commits);
+}
+
+void test_rebegin_with_failing_backend_aborts_once() {
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, 50, digest);
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(digest);
+    ota.write(image, 25);
+    backend.failBegin = true;
+    TEST_ASSERT_FALSE(ota.begin(digest));
+    TEST_ASSERT_EQUAL(OTA_FAILED, ota.status());
+    TEST_ASSERT_EQUAL_STRING("no OTA partition", ota.error());
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+    TEST_ASSERT_FALSE(ota.write(image, 10));
+}
+
+void test_abort_only_touches_backend_while_receiving() {
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, 10, digest);
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.abort();
+    TEST_ASSERT_EQUAL_INT(0, backend.aborts);
+
+    ota.begin(digest);
+    ota.write(image, 10);
+    ota.abort();
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+    TEST_ASSERT_EQUAL(OTA_IDLE, ota.status());
+    TEST_ASSERT_FALSE(ota.end());
+    TEST_ASSERT_EQUAL_INT(0, backend.commits);
+}
+
+void test_reject_replaces_stale_state() {
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, 10, digest);
+
+    // A previous upload failed; the next request has no usable digest
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(digest);
+    ota.end();
+    TEST_ASSERT_EQUAL_STRING("empty image", ota.error());
+    ota.reject("missing or malformed sha256");
+    TEST_ASSERT_EQUAL(OTA_FAILED, ota.status());
+    TEST_ASSERT_EQUAL_STRING("missing or malformed sha256", ota.error());
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+
+    // The rest of the upload is ignored
+    TEST_ASSERT_FALSE(ota.write(image, 10));
+    TEST_ASSERT_FALSE(ota.end());
+    TEST_ASSERT_EQUAL_UINT32(0, ota.bytesReceived());
+    TEST_ASSERT_EQUAL_INT(0, backend.writeCount);
+    TEST_ASSERT_EQUAL_INT(0, backend.commits);
+}
+
+void test_reject_while_receiving_aborts_once() {
+    uint8_t digest[OTA_SHA256_LEN];
+    digestOf(image, 50, digest);
+
+    OtaStream<TEST_CHUNK> ota(backend, hasher);
+    ota.begin(digest);
+    ota.write(image, 25);
+    ota.reject("missing or malformed sha256");
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+    TEST_ASSERT_EQUAL_STRING("missing or malformed sha256", ota.error());
+    ota.abort();
+    TEST_ASSERT_EQUAL_INT(1, backend.aborts);
+}
+
+void test_parse_sha256_hex() {
+    uint8_t out[OTA_SHA256_LEN];
+    const char *hex = "00112233445566778899aabbccddeeffFFEEDDCCBBAA99887766554433221100";
+    TEST_ASSERT_TRUE(parseSha256Hex(hex, out));
+    TEST_ASSERT_EQUAL_HEX8(0x00, out[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x11, out[1]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, out[16]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, out[31]);
+
+    TEST_ASSERT_FALSE(parseSha256Hex(nullptr, out));
+    TEST_ASSERT_FALSE(parseSha256Hex("0011", out));
+    TEST_ASSERT_FALSE(parseSha256Hex("g0112233445566778899aabbccddeeffFFEEDDCCBBAA99887766554433221100", out));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_regroups_odd_pieces_into_chunks);
+    RUN_TEST(test_piece_spanning_several_chunks);
+    RUN_TEST(test_exact_chunk_multiple_has_no_tail_write);
+    RUN_TEST(test_sha_mismatch_aborts);
+    RUN_TEST(test_flash_write_failure_aborts);
+    RUN_TEST(test_commit_failure_aborts);
+    RUN_TEST(test_empty_image_fails);
+    RUN_TEST(test_rebegin_while_receiving_restarts);
+    RUN_TEST(test_rebegin_with_failing_backend_aborts_once);
+    RUN_TEST(test_abort_only_touches_backend_while_receiving);
+    RUN_TEST(test_reject_replaces_stale_state);
+    RUN_TEST(test_reject_while_receiving_aborts_once);
+    RUN_TEST(test_parse_sha256_hex);
+    return UNITY_END();
+}
@@ -0,0 +1,361 @@
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <lvgl.h>
+#include "screen_view.h"
+
+// Headless render regression tests. The screens are built by screen_view.h,
+// exactly as on the gauge, and rendered by LVGL through a flush_cb that
+// writes into an in-memory RGB565 framebuffer. A scripted sequence of states
+// (cold start, idle, redline, each alarm) is compared pixel by pixel against
+// the goldens in test/golden/<state>.ppm, and each state's full-frame render
+// time and the pixels invalidated by moving to it from the previous state
+// are checked against test/golden/render_stats.txt ("name us px" per line).
+//
+// A pixel differs when any channel is more than GOLDEN_CHANNEL_TOL off; a
+// state fails when more than GOLDEN_MAX_DIFF_PX pixels differ, which absorbs
+// anti-aliasing changes between LVGL patch releases. On a failure the actual
+// frame is written next to the golden as <state>.actual.ppm. A missing
+// golden or baseline fails too. After an intended layout change run with
+// GOLDEN_UPDATE=1 to re-record the goldens and stats, then review and commit
+// the new images with the change.
+
+#define RENDER_WIDTH  240
+#define RENDER_HEIGHT 240
+#define RENDER_BUF_LINES 10        // partial draw buffer, as on the gauge
+#define RENDER_REPEATS 20          // full redraws timed per state, best of
+
+#define GOLDEN_CHANNEL_TOL 16      // out of 255: two steps of a 5-bit channel
+#define GOLDEN_MAX_DIFF_PX 120     // about 0.2% of the frame
+#define RENDER_TIME_TOLERANCE 1.5
+#define RENDER_TIME_SLACK_US 50.0
+#define RENDER_PX_TOLERANCE 1.05
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "test/golden"
+#endif
+#define STATS_PATH GOLDEN_DIR "/render_stats.txt"
+
+// --- Memory display ---
+
+static lv_color_t frame[RENDER_WIDTH * RENDER_HEIGHT];
+static lv_color_t drawBuf[RENDER_WIDTH * RENDER_BUF_LINES];
+static lv_disp_draw_buf_t dispBuf;
+static lv_disp_drv_t dispDrv;
+static uint32_t invalidatedPx;
+
+static void memoryFlush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p) {
+    int32_t w = lv_area_get_width(area);
+    for (int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(&frame[y * RENDER_WIDTH + area->x1], color_p, w * sizeof(lv_color_t));
+        color_p += w;
+    }
+    lv_disp_flush_ready(disp);
+}
+
+static void memoryMonitor(lv_disp_drv_t *disp, uint32_t time_ms, uint32_t px) {
+    (void)disp;
+    (void)time_ms;  // whole milliseconds only; timed with steady_clock instead
+    invalidatedPx += px;
+}
+
+static uint32_t hostClock() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+static void printLog(const char *line) {
+    printf("view: %s\n", line);
+}
+
+static void printLvglLog(const char *buf) {
+    printf("%s", buf);
+}
+
+// --- Scripted states ---
+
+struct RenderState {
+    const char *name;
+    int screen;
+    int32_t psi, tempF, rpm, expectedPsi;
+    int32_t psiMin, psiMax, psiAvg, tempMinF, tempMaxF;
+    uint8_t fault;
+    bool alarm;
+    int32_t alarmCount;
+    const char *alarmText;
+};
+
+#define NO_DATA VALUE_NONE
+#define ALARM_LOG_TEXT "4:12 SENSOR OPEN\n3:40 HOT C 119\n2:05 LOW PSI 18"
+
+static const RenderState STATES[] = {
+    // name                scr psi       tF    rpm    exp  lo   hi   avg       tMin  tMax  fault         alarm   n   log
+    {"cold_start",          0,  78,       100,  1400,  30,  76,  80,  78,       100,  100,  SENSOR_OK,    false,  0,  nullptr},
+    {"idle",                0,  28,       194,  800,   10,  26,  80,  29,       100,  196,  SENSOR_OK,    false,  0,  nullptr},
+    {"redline",             0,  72,       212,  7200,  55,  26,  74,  70,       100,  214,  SENSOR_OK,    false,  0,  nullptr},
+    {"redline_bar",         1,  72,       212,  7200,  55,  26,  74,  70,       100,  214,  SENSOR_OK,    false,  0,  nullptr},
+    {"alarm_low_psi_bar",   1,  18,       212,  4000,  40,  18,  74,  25,       100,  214,  SENSOR_OK,    true,   1,  nullptr},
+    {"alarm_low_psi",       0,  18,       212,  4000,  40,  18,  74,  25,       100,  214,  SENSOR_OK,    true,   1,  nullptr},
+    {"alarm_high_temp",     0,  45,       246,  3000,  30,  18,  74,  44,       100,  248,  SENSOR_OK,    false,  2,  nullptr},
+    {"alarm_sensor_open",   0,  NO_DATA,  246,  3000,  30,  18,  74,  44,       100,  248,  SENSOR_OPEN,  true,   3,  nullptr},
+    {"alarm_log",           3,  NO_DATA,  246,  3000,  30,  18,  74,  44,       100,  248,  SENSOR_OPEN,  true,   3,  ALARM_LOG_TEXT},
+    {"minmax",              2,  NO_DATA,  246,  3000,  30,  18,  74,  NO_DATA,  100,  248,  SENSOR_OPEN,  true,   3,  nullptr},
+};
+#define STATE_COUNT (sizeof(STATES) / sizeof(STATES[0]))
+
+static const RenderState *current;
+
+static int32_t stateValue(uint8_t binding) {
+    switch (binding) {
+        case BIND_PSI:          return current->psi;
+        case BIND_TEMP_F:       return current->tempF;
+        case BIND_RPM:          return current->rpm;
+        case BIND_EXPECTED_PSI: return current->expectedPsi;
+        case BIND_PSI_MIN:      return current->psiMin;
+        case BIND_PSI_MAX:      return current->psiMax;
+        case BIND_PSI_AVG_10S:  return current->psiAvg;
+        case BIND_TEMP_MIN_F:   return current->tempMinF;
+        case BIND_TEMP_MAX_F:   return current->tempMaxF;
+        case BIND_ALARM_COUNT:  return current->alarmCount;
+        case BIND_SENSOR_FAULT: return current->fault;
+        default:                return VALUE_NONE;
+    }
+}
+
+static bool stateAlarm() { return current->alarm; }
+
+static size_t stateAlarmText(char *buf, size_t len) {
+    if (!current->alarmText) return 0;
+    snprintf(buf, len, "%s", current->alarmText);
+    return strlen(buf);
+}
+
+static const ScreenViewSource stateSource = {stateValue, stateAlarm, stateAlarmText};
+static ScreenView *view;
+
+// --- Golden images (binary PPM, RGB888) ---
+
+static void pixelRgb(lv_color_t c, uint8_t *rgb) {
+    lv_color32_t c32;
+    c32.full = lv_color_to32(c);
+    rgb[0] = c32.ch.red;
+    rgb[1] = c32.ch.green;
+    rgb[2] = c32.ch.blue;
+}
+
+static bool writePpm(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", RENDER_WIDTH, RENDER_HEIGHT);
+    for (int i = 0; i < RENDER_WIDTH * RENDER_HEIGHT; i++) {
+        uint8_t rgb[3];
+        pixelRgb(frame[i], rgb);
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+    return true;
+}
+
+// Returns the number of pixels beyond tolerance, or -1 if there is no golden
+static int compareGolden(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    int w = 0, h = 0, maxval = 0;
+    if (fscanf(f, "P6 %d %d %d", &w, &h, &maxval) != 3 || w != RENDER_WIDTH ||
+        h != RENDER_HEIGHT || maxval != 255 || fgetc(f) == EOF) {
+        fclose(f);
+        return RENDER_WIDTH * RENDER_HEIGHT;
+    }
+
+    int diff = 0;
+    for (int i = 0; i < RENDER_WIDTH * RENDER_HEIGHT; i++) {
+        uint8_t want[3], got[3];
+        if (fread(want, 1, 3, f) != 3) {
+            diff += RENDER_WIDTH * RENDER_HEIGHT - i;
+            break;
+        }
+        pixelRgb(frame[i], got);
+        for (int ch = 0; ch < 3; ch++) {
+            if (abs(want[ch] - got[ch]) > GOLDEN_CHANNEL_TOL) {
+                diff++;
+                break;
+            }
+        }
+    }
+    fclose(f);
+    return diff;
+}
+
+// --- Render stats ---
+
+struct RenderStats {
+    double us;
+    uint32_t px;
+    bool known;
+};
+
+static RenderStats baseline[STATE_COUNT];
+static RenderStats measured[STATE_COUNT];
+static bool recordStats[STATE_COUNT];
+static bool updateMode;
+
+static void loadStats() {
+    FILE *f = fopen(STATS_PATH, "r");
+    if (!f) return;
+    char key[64];
+    double us;
+    unsigned px;
+    while (fscanf(f, "%63s %lf %u", key, &us, &px) == 3) {
+        for (size_t i = 0; i < STATE_COUNT; i++) {
+            if (strcmp(key, STATES[i].name) == 0) baseline[i] = {us, px, true};
+        }
+    }
+    fclose(f);
+}
+
+static bool saveStats() {
+    FILE *f = fopen(STATS_PATH, "w");
+    if (!f) return false;
+    for (size_t i = 0; i < STATE_COUNT; i++) {
+        const RenderStats &s = recordStats[i] ? measured[i] : baseline[i];
+        if (s.known) fprintf(f, "%s %.1f %u\n", STATES[i].name, s.us, (unsigned)s.px);
+    }
+    fclose(f);
+    return true;
+}
+
+// --- Harness ---
+
+// Move to a state: switch screens if needed, push the values and refresh.
+// Returns the pixels LVGL invalidated for the change.
+static uint32_t enterState(const RenderState &st) {
+    current = &st;
+    invalidatedPx = 0;
+    if (view->active() != st.screen) {
+        TEST_ASSERT_TRUE_MESSAGE(view->show(st.screen), "screen not created");
+    } else {
+        view->update(false);
+        lv_refr_now(NULL);
+    }
+    return invalidatedPx;
+}
+
+// Best-of full-frame redraw time of the current state, in microseconds
+static double fullRenderUs() {
+    double best = 1e300;
+    for (int r = 0; r < RENDER_REPEATS; r++) {
+        lv_obj_invalidate(lv_scr_act());
+        auto start = std::chrono::steady_clock::now();
+        lv_refr_now(NULL);
+        auto end = std::chrono::steady_clock::now();
+        double us = std::chrono::duration<double, std::micro>(end - start).count();
+        if (us < best) best = us;
+    }
+    return best;
+}
+
+static void renderState(size_t idx) {
+    const RenderState &st = STATES[idx];
+    uint32_t px = enterState(st);
+    double us = fullRenderUs();
+    measured[idx] = {us, px, true};
+
+    const RenderStats &base = baseline[idx];
+    printf("%-20s %8.1f us %7u px   baseline %8.1f us %7u px\n", st.name, us, (unsigned)px,
+           base.known ? base.us : 0.0, base.known ? (unsigned)base.px : 0u);
+
+    char golden[160];
+    snprintf(golden, sizeof(golden), "%s/%s.ppm", GOLDEN_DIR, st.name);
+    int diff = compareGolden(golden);
+
+    char msg[200];
+    if (updateMode) {
+        // Re-record everything; the new images are reviewed before commit
+        mkdir(GOLDEN_DIR, 0755);
+        TEST_ASSERT_TRUE_MESSAGE(writePpm(golden), "cannot write golden");
+        recordStats[idx] = true;
+        TEST_IGNORE_MESSAGE("golden and render stats recorded");
+    }
+
+    if (diff < 0) {
+        snprintf(msg, sizeof(msg), "no golden %s, record it with GOLDEN_UPDATE=1", golden);
+        TEST_FAIL_MESSAGE(msg);
+    }
+    if (diff > GOLDEN_MAX_DIFF_PX) {
+        char actual[170];
+        snprintf(actual, sizeof(actual), "%s/%s.actual.ppm", GOLDEN_DIR, st.name);
+        writePpm(actual);
+        snprintf(msg, sizeof(msg), "%d px differ from %s (max %d), see %s",
+                 diff, golden, GOLDEN_MAX_DIFF_PX, actual);
+        TEST_FAIL_MESSAGE(msg);
+    }
+    if (!base.known) {
+        snprintf(msg, sizeof(msg), "no baseline in %s, record it with GOLDEN_UPDATE=1", STATS_PATH);
+        TEST_FAIL_MESSAGE(msg);
+    }
+    if (px > base.px * RENDER_PX_TOLERANCE) {
+        snprintf(msg, sizeof(msg), "%u px invalidated (baseline %u)", (unsigned)px, (unsigned)base.px);
+        TEST_FAIL_MESSAGE(msg);
+    }
+    if (us > base.us * RENDER_TIME_TOLERANCE + RENDER_TIME_SLACK_US) {
+        snprintf(msg, sizeof(msg), "%.1f us per frame (baseline %.1f)", us, base.us);
+        TEST_FAIL_MESSAGE(msg);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+// States run in table order: each one's invalidated area is its change from the one before
+void test_cold_start() { renderState(0); }
+void test_idle() { renderState(1); }
+void test_redline() { renderState(2); }
+void test_redline_bar() { renderState(3); }
+void test_alarm_low_psi_bar() { renderState(4); }
+void test_alarm_low_psi() { renderState(5); }
+void test_alarm_high_temp() { renderState(6); }
+void test_alarm_sensor_open() { renderState(7); }
+void test_alarm_log() { renderState(8); }
+void test_minmax() { renderState(9); }
+
+int main() {
+    lv_init();
+    lv_log_register_print_cb(printLvglLog);
+    lv_disp_draw_buf_init(&dispBuf, drawBuf, nullptr, RENDER_WIDTH * RENDER_BUF_LINES);
+    lv_disp_drv_init(&dispDrv);
+    dispDrv.hor_res = RENDER_WIDTH;
+    dispDrv.ver_res = RENDER_HEIGHT;
+    dispDrv.flush_cb = memoryFlush;
+    dispDrv.monitor_cb = memoryMonitor;
+    dispDrv.draw_buf = &dispBuf;
+    lv_disp_drv_register(&dispDrv);
+
+    static ScreenView screenView(stateSource, hostClock, printLog);
+    view = &screenView;
+    updateMode = getenv("GOLDEN_UPDATE") != nullptr;
+    loadStats();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_cold_start);
+    RUN_TEST(test_idle);
+    RUN_TEST(test_redline);
+    RUN_TEST(test_redline_bar);
+    RUN_TEST(test_alarm_low_psi_bar);
+    RUN_TEST(test_alarm_low_psi);
+    RUN_TEST(test_alarm_high_temp);
+    RUN_TEST(test_alarm_sensor_open);
+    RUN_TEST(test_alarm_log);
+    RUN_TEST(test_minmax);
+    int failures = UNITY_END();
+
+    bool statsDirty = false;
+    for (size_t i = 0; i < STATE_COUNT; i++) statsDirty |= recordStats[i];
+    if (statsDirty && !saveStats()) {
+        printf("cannot write %s\n", STATS_PATH);
+        failures++;
+    }
+    return failures;
+}
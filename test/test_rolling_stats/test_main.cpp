@@ -0,0 +1,108 @@
+#include <unity.h>
+#include <stdio.h>
+#include "rolling_stats.h"
+
+// Sliding-window stats checked sample by sample against a brute-force scan
+// of the last N inputs.
+
+#define WINDOW 10
+#define RAMP_SAMPLES 50
+#define RANDOM_SAMPLES 5000
+
+static float history[RANDOM_SAMPLES];
+
+void setUp() {}
+void tearDown() {}
+
+static void checkWindow(const WindowStats<WINDOW> &w, int last) {
+    int first = last + 1 >= WINDOW ? last + 1 - WINDOW : 0;
+    float lo = history[first], hi = history[first];
+    double sum = 0.0;
+    for (int i = first; i <= last; i++) {
+        if (history[i] < lo) lo = history[i];
+        if (history[i] > hi) hi = history[i];
+        sum += history[i];
+    }
+    char msg[48];
+    snprintf(msg, sizeof(msg), "sample %d", last);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(last - first + 1, w.samples(), msg);
+    TEST_ASSERT_EQUAL_FLOAT_MESSAGE(lo, w.min(), msg);
+    TEST_ASSERT_EQUAL_FLOAT_MESSAGE(hi, w.max(), msg);
+    TEST_ASSERT_FLOAT_WITHIN_MESSAGE(1e-3f, (float)(sum / (last - first + 1)), w.mean(), msg);
+}
+
+static void runAgainstBruteForce(int samples) {
+    WindowStats<WINDOW> w;
+    for (int i = 0; i < samples; i++) {
+        w.push(history[i]);
+        checkWindow(w, i);
+    }
+}
+
+void test_empty_window() {
+    WindowStats<WINDOW> w;
+    TEST_ASSERT_EQUAL_UINT32(0, w.samples());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, w.min());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, w.max());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, w.mean());
+}
+
+void test_rising_ramp() {
+    // Every sample is a new max, so the min deque fills to N
+    for (int i = 0; i < RAMP_SAMPLES; i++) history[i] = (float)i;
+    runAgainstBruteForce(RAMP_SAMPLES);
+}
+
+void test_falling_ramp() {
+    // Every sample is a new min, so the max deque fills to N
+    for (int i = 0; i < RAMP_SAMPLES; i++) history[i] = (float)(RAMP_SAMPLES - i);
+    runAgainstBruteForce(RAMP_SAMPLES);
+}
+
+void test_constant_input() {
+    for (int i = 0; i < RAMP_SAMPLES; i++) history[i] = 42.5f;
+    runAgainstBruteForce(RAMP_SAMPLES);
+}
+
+void test_random_input() {
+    uint32_t lcg = 12345;
+    for (int i = 0; i < RANDOM_SAMPLES; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        history[i] = (float)(lcg >> 16) / 655.36f - 50.0f;  // -50..50
+    }
+    runAgainstBruteForce(RANDOM_SAMPLES);
+}
+
+void test_reset_clears_window() {
+    WindowStats<WINDOW> w;
+    for (int i = 0; i < 25; i++) w.push((float)i);
+    w.reset();
+    w.push(-3.0f);
+    TEST_ASSERT_EQUAL_UINT32(1, w.samples());
+    TEST_ASSERT_EQUAL_FLOAT(-3.0f, w.min());
+    TEST_ASSERT_EQUAL_FLOAT(-3.0f, w.max());
+    TEST_ASSERT_EQUAL_FLOAT(-3.0f, w.mean());
+}
+
+void test_session_stats() {
+    SessionStats s;
+    s.push(5.0f);
+    s.push(-1.0f);
+    s.push(8.0f);
+    TEST_ASSERT_EQUAL_UINT32(3, s.samples());
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, s.min());
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, s.max());
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, s.mean());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_window);
+    RUN_TEST(test_rising_ramp);
+    RUN_TEST(test_falling_ramp);
+    RUN_TEST(test_constant_input);
+    RUN_TEST(test_random_input);
+    RUN_TEST(test_reset_clears_window);
+    RUN_TEST(test_session_stats);
+    return UNITY_END();
+}
@@ -0,0 +1,245 @@
+#include <unity.h>
+#include "scheduler.h"
+
+// Scheduler against a fake clock: the test owns time, and jobs "take" time
+// by advancing it from inside their body.
+
+static uint32_t fakeNow;
+static uint32_t fakeClock() { return fakeNow; }
+
+// Per-job run time and a shared log of which job ran, in order
+#define LOG_MAX 128
+static uint32_t costA, costB, costC;
+static char runLog[LOG_MAX + 1];
+static int runLogLen;
+static uint32_t startsA[LOG_MAX];
+static int startsALen;
+
+static void logRun(char c) {
+    if (runLogLen < LOG_MAX) runLog[runLogLen++] = c;
+    runLog[runLogLen] = '\0';
+}
+
+static void jobA() {
+    if (startsALen < LOG_MAX) startsA[startsALen++] = fakeNow;
+    logRun('A');
+    fakeNow += costA;
+}
+static void jobB() { logRun('B'); fakeNow += costB; }
+static void jobC() { logRun('C'); fakeNow += costC; }
+
+// Advance the fake clock to `until`, running due jobs like loop() does
+template <size_t N>
+static void runUntil(Scheduler<N> &s, uint32_t until) {
+    while ((int32_t)(until - fakeNow) > 0) {
+        uint32_t wait = s.runOnce();
+        if (wait == 0) continue;
+        uint32_t left = until - fakeNow;
+        fakeNow += wait < left ? wait : left;
+    }
+}
+
+void setUp() {
+    fakeNow = 1000;
+    costA = costB = costC = 0;
+    runLogLen = 0;
+    runLog[0] = '\0';
+    startsALen = 0;
+}
+void tearDown() {}
+
+void test_fixed_rate_does_not_drift() {
+    Scheduler<2> s(fakeClock);
+    costA = 3000;  // each run takes 3 ms of a 10 ms period
+    TEST_ASSERT_TRUE(s.add("a", jobA, 10000, 10000, 0));
+    s.start();
+
+    // Late starts on every release must not push later releases back
+    for (int i = 0; i < 10; i++) {
+        fakeNow = 1000 + i * 10000 + 700;
+        s.runOnce();
+    }
+
+    TEST_ASSERT_EQUAL_INT(10, startsALen);
+    TEST_ASSERT_EQUAL_UINT32(10, s.job(0).stats.runs);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 10 * 10000, s.job(0).nextRelease);
+    TEST_ASSERT_EQUAL_UINT32(700, s.job(0).stats.maxJitterUs);
+    TEST_ASSERT_EQUAL_UINT32(700, s.job(0).stats.meanJitterUs());
+    TEST_ASSERT_EQUAL_UINT32(3000, s.job(0).stats.maxRunUs);
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).stats.overruns);
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).stats.skipped);
+}
+
+void test_release_times_over_long_run() {
+    Scheduler<1> s(fakeClock);
+    costA = 1234;
+    s.add("a", jobA, 5000, 5000, 0, 2000);
+    s.start();
+    runUntil(s, 1000 + 2000 + 100 * 5000);
+
+    TEST_ASSERT_EQUAL_INT(100, startsALen);
+    for (int i = 0; i < startsALen; i++) {
+        TEST_ASSERT_EQUAL_UINT32(1000 + 2000 + i * 5000, startsA[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).stats.maxJitterUs);
+}
+
+void test_priority_order_when_several_due() {
+    Scheduler<3> s(fakeClock);
+    s.add("low", jobC, 10000, 10000, 2);
+    s.add("high", jobA, 10000, 10000, 0);
+    s.add("mid", jobB, 10000, 10000, 1);
+    s.start();
+
+    // All three released at once
+    while (s.runOnce() == 0) {}
+    TEST_ASSERT_EQUAL_STRING("ABC", runLog);
+}
+
+void test_equal_priority_runs_earliest_release_first() {
+    Scheduler<2> s(fakeClock);
+    s.add("later", jobB, 10000, 10000, 1, 500);
+    s.add("earlier", jobA, 10000, 10000, 1, 100);
+    s.start();
+
+    fakeNow += 1000;  // both overdue
+    while (s.runOnce() == 0) {}
+    TEST_ASSERT_EQUAL_STRING("AB", runLog);
+}
+
+void test_high_priority_preempts_between_runs() {
+    Scheduler<2> s(fakeClock);
+    costB = 4000;  // long low-priority job
+    s.add("fast", jobA, 2000, 2000, 0);
+    s.add("slow", jobB, 20000, 20000, 1, 100);
+    s.start();
+    runUntil(s, 1000 + 10000);
+
+    // The slow job delays one release of the fast one but never two in a row
+    TEST_ASSERT_EQUAL_STRING("ABAAAA", runLog);
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(1, s.job(0).stats.overruns);
+}
+
+void test_overrun_counted_past_deadline() {
+    Scheduler<1> s(fakeClock);
+    s.add("a", jobA, 10000, 2000, 0);
+    s.start();
+
+    costA = 1500;      // finishes inside its deadline
+    s.runOnce();
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).stats.overruns);
+
+    fakeNow = 1000 + 10000 + 1000;
+    costA = 1500;      // started 1 ms late, so ends 0.5 ms past the deadline
+    s.runOnce();
+    TEST_ASSERT_EQUAL_UINT32(1, s.job(0).stats.overruns);
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).stats.skipped);
+}
+
+void test_skipped_releases_are_dropped_not_replayed() {
+    Scheduler<1> s(fakeClock);
+    s.add("a", jobA, 1000, 1000, 0);
+    s.start();
+
+    costA = 3500;  // overruns three and a half periods
+    s.runOnce();
+    TEST_ASSERT_EQUAL_UINT32(1, s.job(0).stats.overruns);
+    // Releases at 2000 and 3000 are gone; 4000 is less than a period late
+    // and still runs, on the original grid
+    TEST_ASSERT_EQUAL_UINT32(2, s.job(0).stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 3000, s.job(0).nextRelease);
+
+    costA = 0;
+    TEST_ASSERT_EQUAL_UINT32(500, s.runOnce());  // late run, then wait for the grid
+    TEST_ASSERT_EQUAL_UINT32(2, s.job(0).stats.runs);
+    TEST_ASSERT_EQUAL_UINT32(500, s.job(0).stats.maxJitterUs);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 4000, s.job(0).nextRelease);
+}
+
+void test_micros_wraparound() {
+    Scheduler<2> s(fakeClock);
+    fakeNow = 0xFFFFFFFFu - 25000;  // wraps 25 ms in
+    costA = 100;
+    s.add("a", jobA, 10000, 10000, 0);
+    s.add("b", jobB, 7000, 7000, 1);
+    s.start();
+
+    uint32_t begin = fakeNow;
+    runUntil(s, begin + 100000);
+
+    TEST_ASSERT_EQUAL_UINT32(10, s.job(0).stats.runs);
+    TEST_ASSERT_EQUAL_UINT32(15, s.job(1).stats.runs);
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(1).stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(0, s.job(0).stats.overruns);
+    TEST_ASSERT_TRUE(s.job(0).stats.maxJitterUs <= 100);
+    for (int i = 0; i < startsALen; i++) {
+        TEST_ASSERT_EQUAL_UINT32(begin + i * 10000, startsA[i]);
+    }
+}
+
+void test_wait_hint_across_wraparound() {
+    Scheduler<1> s(fakeClock);
+    fakeNow = 0xFFFFFFFFu - 99;
+    s.add("a", jobA, 1000, 1000, 0);
+    s.start();
+    s.runOnce();
+    // Next release is just past the wrap
+    TEST_ASSERT_EQUAL_UINT32(900, s.job(0).nextRelease);
+    TEST_ASSERT_EQUAL_UINT32(1000, s.runOnce());
+}
+
+void test_set_period_keeps_phase() {
+    Scheduler<1> s(fakeClock);
+    s.add("a", jobA, 10000, 10000, 0);
+    s.start();
+    s.runOnce();
+    TEST_ASSERT_TRUE(s.setPeriod("a", 2000));
+    TEST_ASSERT_FALSE(s.setPeriod("missing", 2000));
+    TEST_ASSERT_FALSE(s.setPeriod("a", 0));
+
+    // The already-scheduled release stands; the new period applies after it
+    runUntil(s, 1000 + 10000 + 4001);
+    TEST_ASSERT_EQUAL_INT(4, startsALen);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 10000, startsA[1]);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 12000, startsA[2]);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 14000, startsA[3]);
+}
+
+void test_find_by_name() {
+    Scheduler<2> s(fakeClock);
+    s.add("a", jobA, 1000, 1000, 0);
+    s.add("b", jobB, 2000, 2000, 1);
+    s.start();
+    s.runOnce();
+    TEST_ASSERT_NOT_NULL(s.find("a"));
+    TEST_ASSERT_EQUAL_UINT32(1, s.find("a")->stats.runs);
+    TEST_ASSERT_EQUAL_UINT32(2000, s.find("b")->periodUs);
+    TEST_ASSERT_NULL(s.find("missing"));
+}
+
+void test_add_rejects_full_and_zero_period() {
+    Scheduler<1> s(fakeClock);
+    TEST_ASSERT_FALSE(s.add("zero", jobA, 0, 0, 0));
+    TEST_ASSERT_TRUE(s.add("a", jobA, 1000, 1000, 0));
+    TEST_ASSERT_FALSE(s.add("b", jobB, 1000, 1000, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, s.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_rate_does_not_drift);
+    RUN_TEST(test_release_times_over_long_run);
+    RUN_TEST(test_priority_order_when_several_due);
+    RUN_TEST(test_equal_priority_runs_earliest_release_first);
+    RUN_TEST(test_high_priority_preempts_between_runs);
+    RUN_TEST(test_overrun_counted_past_deadline);
+    RUN_TEST(test_skipped_releases_are_dropped_not_replayed);
+    RUN_TEST(test_micros_wraparound);
+    RUN_TEST(test_wait_hint_across_wraparound);
+    RUN_TEST(test_set_period_keeps_phase);
+    RUN_TEST(test_find_by_name);
+    RUN_TEST(test_add_rejects_full_and_zero_period);
+    return UNITY_END();
+}
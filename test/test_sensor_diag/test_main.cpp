@@ -0,0 +1,215 @@
+#include <unity.h>
+#include "sensor_diag.h"
+
+// Sender fault classification from synthetic bursts and a fake pull-up probe
+
+#define TEST_STUCK_N 8
+
+static const SensorLimits LIMITS = {
+    100,   // lowRaw
+    3900,  // highRaw
+    2000,  // probeOpenRaw
+    200,   // noiseSpan
+    2.0f,  // stuckSpan
+};
+
+static uint16_t probeRaw;
+static int probeCalls;
+static uint16_t fakeProbe() {
+    probeCalls++;
+    return probeRaw;
+}
+
+// A full burst centred on `center`, spread +-`spread` counts
+static AdcBurst burst(uint16_t center, uint16_t spread = 4) {
+    AdcBurst b;
+    b.reset();
+    for (uint32_t i = 0; i < OVERSAMPLE_SAMPLES; i++) {
+        b.add(i % 2 ? center + spread : center - spread);
+    }
+    return b;
+}
+
+// A healthy signal that moves well beyond stuckSpan between bursts
+static uint16_t moving(int i) { return 1500 + (i % 5) * 20; }
+
+typedef SensorDiag<TEST_STUCK_N> Diag;
+
+static SensorFault feed(Diag &d, const AdcBurst &b, int times) {
+    SensorFault f = SENSOR_OK;
+    for (int i = 0; i < times; i++) f = d.update(b, LIMITS, fakeProbe);
+    return f;
+}
+
+void setUp() {
+    probeRaw = 0;
+    probeCalls = 0;
+}
+void tearDown() {}
+
+void test_burst_decimation() {
+    AdcBurst b = burst(1000, 3);
+    TEST_ASSERT_EQUAL_UINT32(OVERSAMPLE_SAMPLES, b.n);
+    TEST_ASSERT_EQUAL_UINT32(1000u << OVERSAMPLE_BITS, b.decimated());
+    TEST_ASSERT_EQUAL_FLOAT(1000.0f, b.counts());
+    TEST_ASSERT_EQUAL_UINT32(6, b.span());
+
+    AdcBurst empty;
+    empty.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, empty.span());
+}
+
+void test_healthy_signal_is_ok_without_probing() {
+    Diag d;
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, d.update(burst(moving(i)), LIMITS, fakeProbe));
+    }
+    TEST_ASSERT_EQUAL_INT(0, probeCalls);
+}
+
+void test_open_detected_by_pullup_probe() {
+    Diag d;
+    probeRaw = 4000;  // pull-up wins: nothing on the line
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OPEN, feed(d, burst(20), 3));
+    TEST_ASSERT_EQUAL_INT(3, probeCalls);
+    TEST_ASSERT_EQUAL_STRING("OPEN", sensorFaultName(d.fault()));
+}
+
+void test_short_to_ground_detected_by_pullup_probe() {
+    Diag d;
+    probeRaw = 30;  // pull-up held down by the short
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_SHORT_GND, feed(d, burst(20), 3));
+    TEST_ASSERT_EQUAL_INT(3, probeCalls);
+}
+
+void test_under_range_without_probe_is_short_to_ground() {
+    Diag d;
+    AdcBurst b = burst(20);
+    SensorFault f = SENSOR_OK;
+    for (int i = 0; i < 3; i++) f = d.update(b, LIMITS, nullptr);
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_SHORT_GND, f);
+}
+
+void test_probe_only_when_every_sample_under_range() {
+    Diag d;
+    AdcBurst b = burst(20);
+    b.add(LIMITS.lowRaw);  // one sample back in range
+    feed(d, b, 5);
+    TEST_ASSERT_EQUAL_INT(0, probeCalls);
+}
+
+void test_short_to_supply() {
+    Diag d;
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_SHORT_SUPPLY, feed(d, burst(4050), 3));
+    TEST_ASSERT_EQUAL_INT(0, probeCalls);
+
+    // One sample below highRaw means the line is not pinned, just reading high
+    Diag d2;
+    AdcBurst b = burst(4050);
+    b.add(LIMITS.highRaw - 1);
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, feed(d2, b, 3));
+}
+
+void test_noisy_signal() {
+    Diag d;
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_NOISY, feed(d, burst(1500, 150), 3));  // span 300
+
+    Diag d2;
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, feed(d2, burst(1500, 100), 3));   // span 200, at the limit
+}
+
+void test_stuck_signal() {
+    Diag d;
+    // The window must fill before a flat signal can count as stuck
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, feed(d, burst(1500), TEST_STUCK_N - 1));
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, feed(d, burst(1500), 2));
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_STUCK, feed(d, burst(1500), 1));
+
+    // Movement clears it once the flat samples leave the window and CLEAR
+    // healthy bursts have been seen
+    SensorFault f = SENSOR_STUCK;
+    for (int i = 0; i < TEST_STUCK_N + 10; i++) f = d.update(burst(moving(i)), LIMITS, fakeProbe);
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, f);
+}
+
+void test_small_movement_below_stuck_span_is_stuck() {
+    Diag d;
+    SensorFault f = SENSOR_OK;
+    for (int i = 0; i < TEST_STUCK_N + 3; i++) {
+        f = d.update(burst(1500 + (i % 2)), LIMITS, fakeProbe);  // 1 count of movement
+    }
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_STUCK, f);
+}
+
+void test_rail_reading_restarts_stuck_window() {
+    Diag d;
+    feed(d, burst(1500), TEST_STUCK_N - 1);
+    probeRaw = 4000;
+    d.update(burst(20), LIMITS, fakeProbe);  // one open burst, not confirmed
+    // The window starts over, so another TEST_STUCK_N - 1 flat bursts are not enough
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, feed(d, burst(1500), TEST_STUCK_N - 1));
+}
+
+void test_fault_needs_confirm_consecutive_bursts() {
+    Diag d;
+    probeRaw = 4000;
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, feed(d, burst(20), 2));
+    // A healthy burst in between restarts the count
+    d.update(burst(moving(0)), LIMITS, fakeProbe);
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, feed(d, burst(20), 2));
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OPEN, feed(d, burst(20), 1));
+}
+
+void test_fault_clears_after_clear_healthy_bursts() {
+    Diag d;
+    probeRaw = 4000;
+    feed(d, burst(20), 3);
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OPEN, d.fault());
+
+    int i = 0;
+    for (; i < 9; i++) {
+        TEST_ASSERT_EQUAL_UINT8(SENSOR_OPEN, d.update(burst(moving(i)), LIMITS, fakeProbe));
+    }
+    // A fault burst just before the tenth restarts the clear count
+    d.update(burst(20), LIMITS, fakeProbe);
+    for (int j = 0; j < 9; j++, i++) {
+        TEST_ASSERT_EQUAL_UINT8(SENSOR_OPEN, d.update(burst(moving(i)), LIMITS, fakeProbe));
+    }
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, d.update(burst(moving(i)), LIMITS, fakeProbe));
+}
+
+void test_confirmed_fault_switches_to_new_fault() {
+    Diag d;
+    probeRaw = 4000;
+    feed(d, burst(20), 3);
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OPEN, feed(d, burst(4050), 2));  // not yet confirmed
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_SHORT_SUPPLY, feed(d, burst(4050), 1));
+}
+
+void test_reset_clears_fault() {
+    Diag d;
+    feed(d, burst(4050), 3);
+    d.reset();
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, d.fault());
+    TEST_ASSERT_EQUAL_UINT8(SENSOR_OK, d.update(burst(moving(0)), LIMITS, fakeProbe));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_burst_decimation);
+    RUN_TEST(test_healthy_signal_is_ok_without_probing);
+    RUN_TEST(test_open_detected_by_pullup_probe);
+    RUN_TEST(test_short_to_ground_detected_by_pullup_probe);
+    RUN_TEST(test_under_range_without_probe_is_short_to_ground);
+    RUN_TEST(test_probe_only_when_every_sample_under_range);
+    RUN_TEST(test_short_to_supply);
+    RUN_TEST(test_noisy_signal);
+    RUN_TEST(test_stuck_signal);
+    RUN_TEST(test_small_movement_below_stuck_span_is_stuck);
+    RUN_TEST(test_rail_reading_restarts_stuck_window);
+    RUN_TEST(test_fault_needs_confirm_consecutive_bursts);
+    RUN_TEST(test_fault_clears_after_clear_healthy_bursts);
+    RUN_TEST(test_confirmed_fault_switches_to_new_fault);
+    RUN_TEST(test_reset_clears_fault);
+    return UNITY_END();
+}
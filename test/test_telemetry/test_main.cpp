@@ -0,0 +1,185 @@
+#include <unity.h>
+#include "telemetry.h"
+
+// Telemetry framing: CRC, COBS with embedded zeros, and whole frames decoded
+// back the way scripts/telemetry_decode.py does it.
+
+void setUp() {}
+void tearDown() {}
+
+// Reference COBS decoder, same rules as cobs_decode() in the Python script.
+// Returns the decoded length, or -1 for a malformed frame.
+static int cobsDecode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t i = 0, o = 0;
+    while (i < len) {
+        uint8_t code = in[i];
+        if (code == 0 || i + code > len) return -1;
+        for (size_t k = 1; k < code; k++) out[o++] = in[i + k];
+        i += code;
+        if (code < 0xFF && i < len) out[o++] = 0;
+    }
+    return (int)o;
+}
+
+static void checkCobs(const uint8_t *in, size_t len, const uint8_t *want, size_t wantLen) {
+    uint8_t enc[300];
+    size_t n = cobsEncode(in, len, enc);
+    TEST_ASSERT_EQUAL_UINT32(wantLen, n);
+    TEST_ASSERT_EQUAL_MEMORY(want, enc, wantLen);
+
+    uint8_t dec[300];
+    TEST_ASSERT_EQUAL_INT((int)len, cobsDecode(enc, n, dec));
+    TEST_ASSERT_EQUAL_MEMORY(in, dec, len);
+}
+
+static TelemetryRecord sampleRecord() {
+    TelemetryRecord r = {};
+    r.version = TELEMETRY_VERSION;
+    r.flags = TELEM_FLAG_LOW_PRESS;
+    r.seq = 0x0100;           // low byte zero
+    r.timeUs = 0x00012340;    // high byte zero
+    r.adcRaw = 0;             // simulated: two zero bytes
+    r.psiX100 = 4250;
+    r.psiFilteredX100 = -5;
+    r.tempCX10 = 905;
+    r.rpm = 3000;
+    return r;
+}
+
+// The frame for sampleRecord(); scripts/test_telemetry_decode.py decodes the
+// same bytes, so the two sides cannot drift apart unnoticed
+static const uint8_t SAMPLE_FRAME[] = {
+    0x03, 0x01, 0x02, 0x05, 0x01, 0x40, 0x23, 0x01, 0x01, 0x01, 0x0B,
+    0x9A, 0x10, 0xFB, 0xFF, 0x89, 0x03, 0xB8, 0x0B, 0xF6, 0xCF, 0x00,
+};
+
+void test_crc16_check_value() {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_UINT16(0x29B1, crc16Ccitt(check, sizeof(check)));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, crc16Ccitt(check, 0));
+}
+
+void test_cobs_reference_vectors() {
+    const uint8_t z1[] = {0x00};
+    const uint8_t z1e[] = {0x01, 0x01};
+    checkCobs(z1, sizeof(z1), z1e, sizeof(z1e));
+
+    const uint8_t z2[] = {0x00, 0x00};
+    const uint8_t z2e[] = {0x01, 0x01, 0x01};
+    checkCobs(z2, sizeof(z2), z2e, sizeof(z2e));
+
+    const uint8_t mid[] = {0x11, 0x22, 0x00, 0x33};
+    const uint8_t mide[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+    checkCobs(mid, sizeof(mid), mide, sizeof(mide));
+
+    const uint8_t none[] = {0x11, 0x22, 0x33, 0x44};
+    const uint8_t nonee[] = {0x05, 0x11, 0x22, 0x33, 0x44};
+    checkCobs(none, sizeof(none), nonee, sizeof(nonee));
+
+    const uint8_t tail[] = {0x11, 0x00, 0x00, 0x00};
+    const uint8_t taile[] = {0x02, 0x11, 0x01, 0x01, 0x01};
+    checkCobs(tail, sizeof(tail), taile, sizeof(taile));
+
+    uint8_t enc[4];
+    TEST_ASSERT_EQUAL_UINT32(1, cobsEncode(nullptr, 0, enc));  // empty input is a lone 0x01
+    TEST_ASSERT_EQUAL_UINT8(0x01, enc[0]);
+}
+
+void test_cobs_long_run_splits_blocks() {
+    // 300 non-zero bytes need a 0xFF block; output must never contain 0x00
+    uint8_t in[300], enc[310], dec[310];
+    for (int i = 0; i < 300; i++) in[i] = (uint8_t)(i % 255 + 1);
+    size_t n = cobsEncode(in, sizeof(in), enc);
+    TEST_ASSERT_EQUAL_UINT8(0xFF, enc[0]);
+    for (size_t i = 0; i < n; i++) TEST_ASSERT_TRUE(enc[i] != 0);
+    TEST_ASSERT_EQUAL_INT(300, cobsDecode(enc, n, dec));
+    TEST_ASSERT_EQUAL_MEMORY(in, dec, sizeof(in));
+}
+
+void test_cobs_decoder_rejects_truncated_block() {
+    const uint8_t mid[] = {0x11, 0x22, 0x00, 0x33};
+    uint8_t enc[8], dec[8];
+    size_t n = cobsEncode(mid, sizeof(mid), enc);
+    TEST_ASSERT_EQUAL_INT(-1, cobsDecode(enc, n - 1, dec));
+}
+
+void test_frame_matches_reference_bytes() {
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    size_t n = telemetryFrame(sampleRecord(), frame);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(SAMPLE_FRAME), n);
+    TEST_ASSERT_EQUAL_MEMORY(SAMPLE_FRAME, frame, n);
+}
+
+void test_frame_round_trip() {
+    TelemetryRecord rec = sampleRecord();
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    size_t n = telemetryFrame(rec, frame);
+    TEST_ASSERT_TRUE(n <= TELEMETRY_FRAME_MAX);
+
+    // Only the delimiter is zero, so a receiver can resync on it
+    TEST_ASSERT_EQUAL_UINT8(0x00, frame[n - 1]);
+    for (size_t i = 0; i + 1 < n; i++) TEST_ASSERT_TRUE(frame[i] != 0);
+
+    uint8_t raw[TELEMETRY_FRAME_MAX];
+    TEST_ASSERT_EQUAL_INT((int)TELEMETRY_RAW_LEN, cobsDecode(frame, n - 1, raw));
+    uint16_t crc = raw[sizeof(rec)] | (raw[sizeof(rec) + 1] << 8);
+    TEST_ASSERT_EQUAL_UINT16(crc16Ccitt(raw, sizeof(rec)), crc);
+
+    TelemetryRecord back;
+    memcpy(&back, raw, sizeof(back));
+    TEST_ASSERT_EQUAL_MEMORY(&rec, &back, sizeof(rec));
+}
+
+void test_frame_crc_catches_corruption() {
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    size_t n = telemetryFrame(sampleRecord(), frame);
+    frame[12] ^= 0x04;  // one bit in a data byte
+
+    uint8_t raw[TELEMETRY_FRAME_MAX];
+    TEST_ASSERT_EQUAL_INT((int)TELEMETRY_RAW_LEN, cobsDecode(frame, n - 1, raw));
+    uint16_t crc = raw[sizeof(TelemetryRecord)] | (raw[sizeof(TelemetryRecord) + 1] << 8);
+    TEST_ASSERT_TRUE(crc16Ccitt(raw, sizeof(TelemetryRecord)) != crc);
+}
+
+void test_tx_ring_drops_whole_frames() {
+    TxRing<50> ring;
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    size_t n = telemetryFrame(sampleRecord(), frame);
+
+    TEST_ASSERT_TRUE(ring.push(frame, n));
+    TEST_ASSERT_TRUE(ring.push(frame, n));
+    TEST_ASSERT_FALSE(ring.push(frame, n));  // 44 of 50 used, no room for 22
+    TEST_ASSERT_EQUAL_UINT32(1, ring.droppedFrames());
+    TEST_ASSERT_EQUAL_UINT32(2 * n, ring.size());
+
+    // Drain part, refill across the wrap and read it back in order
+    const uint8_t *data;
+    TEST_ASSERT_EQUAL_UINT32(2 * n, ring.peek(&data));
+    ring.consume(n);
+    TEST_ASSERT_TRUE(ring.push(frame, n));
+
+    uint8_t out[3 * TELEMETRY_FRAME_MAX];
+    size_t got = 0;
+    while (ring.size()) {
+        size_t run = ring.peek(&data);
+        memcpy(out + got, data, run);
+        got += run;
+        ring.consume(run);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2 * n, got);
+    TEST_ASSERT_EQUAL_MEMORY(frame, out, n);
+    TEST_ASSERT_EQUAL_MEMORY(frame, out + n, n);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_cobs_reference_vectors);
+    RUN_TEST(test_cobs_long_run_splits_blocks);
+    RUN_TEST(test_cobs_decoder_rejects_truncated_block);
+    RUN_TEST(test_frame_matches_reference_bytes);
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_frame_crc_catches_corruption);
+    RUN_TEST(test_tx_ring_drops_whole_frames);
+    return UNITY_END();
+}